@@ -1,3 +0,0 @@
-C:/VulkanSDK/1.2.131.2/Bin32/glslangValidator.exe -V ../shaders/shader.vert
-C:/VulkanSDK/1.2.131.2/Bin32/glslangValidator.exe -V ../shaders/shader.frag
-pause
\ No newline at end of file
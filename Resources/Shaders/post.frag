@@ -0,0 +1,44 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_EXT_samplerless_texture_functions : require
+
+// Shares the scene's pipeline layout, so this overlays the start of SceneConstants.
+layout(push_constant) uniform PostConstants {
+    uint sourceHandle;
+    // 0 blurs horizontally, 1 vertically, 2 applies the vignette.
+    uint mode;
+};
+
+layout(set = 0, binding = 1) uniform texture2D textures[];
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+vec4 Load(ivec2 aCoord, ivec2 aSize) {
+    return texelFetch(textures[sourceHandle], clamp(aCoord, ivec2(0), aSize - 1), 0);
+}
+
+void main() {
+    ivec2 size = textureSize(textures[sourceHandle], 0);
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+
+    if (mode == 2) {
+        vec2 fromCenter = fragTexCoord - 0.5;
+        float vignette = 1.0 - smoothstep(0.3, 0.75, length(fromCenter));
+        outColor = vec4(Load(coord, size).rgb * vignette, 1.0);
+        return;
+    }
+
+    ivec2 direction = mode == 0 ? ivec2(1, 0) : ivec2(0, 1);
+    vec4 color = Load(coord, size) * weights[0];
+    for (int i = 1; i < 5; i++) {
+        color += Load(coord + direction * i, size) * weights[i];
+        color += Load(coord - direction * i, size) * weights[i];
+    }
+
+    outColor = color;
+}
@@ -0,0 +1,10 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) out vec2 fragTexCoord;
+
+// One triangle covering the whole target, without vertex buffers.
+void main() {
+    fragTexCoord = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(fragTexCoord * 2.0 - 1.0, 0.0, 1.0);
+}
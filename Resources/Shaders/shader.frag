@@ -1,10 +1,30 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(push_constant) uniform SceneConstants {
+    uint materialBufferHandle;
+    uint materialCount;
+    uint textureHandle;
+    uint samplerHandle;
+};
+
+// Binding 0 of the bindless set holds every storage buffer; the handle picks one.
+layout(set = 0, binding = 0) readonly buffer MaterialBuffer {
+    vec4 colors[];
+} materialBuffers[];
+
+// Bindings 1 and 2 hold the sampled images and samplers.
+layout(set = 0, binding = 1) uniform texture2D textures[];
+layout(set = 0, binding = 2) uniform sampler samplers[];
 
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) flat in uint fragMaterialIndex;
+layout(location = 2) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    vec4 texel = texture(sampler2D(textures[textureHandle], samplers[samplerHandle]), fragTexCoord);
+    outColor = vec4(fragColor, 1.0) * materialBuffers[materialBufferHandle].colors[fragMaterialIndex] * texel;
+}
@@ -1,21 +1,30 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(location = 0) out vec3 fragColor;
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inOffset;
+layout(location = 3) in float inScale;
+
+// Written once per frame into the uniform ring and bound with a dynamic offset.
+layout(set = 1, binding = 0) uniform FrameUniforms {
+    mat4 viewProjection;
+};
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
-    vec2(0.5, 0.5),
-    vec2(-0.5, 0.5)
-);
+layout(push_constant) uniform SceneConstants {
+    uint materialBufferHandle;
+    uint materialCount;
+    uint textureHandle;
+    uint samplerHandle;
+};
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) flat out uint fragMaterialIndex;
+layout(location = 2) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
-}
\ No newline at end of file
+    gl_Position = viewProjection * vec4(inPosition * inScale + inOffset, 0.0, 1.0);
+    fragColor = inColor;
+    fragMaterialIndex = uint(gl_InstanceIndex) % materialCount;
+    fragTexCoord = inPosition + 0.5;
+}
@@ -0,0 +1,300 @@
+#include "ApplicationSettings.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace ApplicationSettingsPrivate
+{
+    static constexpr uint32_t ourDefaultHeadlessFrameCount = 1000;
+    static constexpr uint32_t ourMaxDefaultRecordingThreadCount = 8;
+    static constexpr uint32_t ourDefaultDrawBenchmarkFrameCount = 100;
+    static constexpr uint32_t ourDefaultDrawBenchmarkObjectCount = 1000000;
+    static constexpr uint32_t ourDefaultMsaaBenchmarkObjectCount = 10000;
+    static constexpr uint32_t ourMaxMsaaSampleCount = 64;
+    static constexpr uint32_t ourMaxFramesInFlightCount = 4;
+
+    // argv[0] is only the name when the executable was found through PATH, and the link when started through a
+    // symbolic link, so ask the OS instead. Empty if it cannot tell.
+    static std::filesystem::path GetExecutableDirectory()
+    {
+#ifdef _WIN32
+        std::wstring path(MAX_PATH, L'\0');
+        DWORD length = 0;
+        while ((length = GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size()))) == path.size())
+            path.resize(path.size() * 2);
+
+        if (length == 0)
+            return {};
+
+        path.resize(length);
+        return std::filesystem::path(path).parent_path();
+#else
+        std::error_code error;
+        const std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", error);
+        return error ? std::filesystem::path() : path.parent_path();
+#endif
+    }
+
+    static std::string ParseString(const std::string& anOption, const char* aValue)
+    {
+        if (!aValue)
+            throw std::runtime_error("missing value for " + anOption + "!");
+
+        return aValue;
+    }
+
+    static uint32_t ParseUnsigned(const std::string& anOption, const char* aValue)
+    {
+        if (!aValue)
+            throw std::runtime_error("missing value for " + anOption + "!");
+
+        try
+        {
+            return static_cast<uint32_t>(std::stoul(aValue));
+        }
+        catch (const std::exception&)
+        {
+            throw std::runtime_error("invalid value for " + anOption + ": " + aValue);
+        }
+    }
+
+    static float ParsePositiveFloat(const std::string& anOption, const char* aValue)
+    {
+        if (!aValue)
+            throw std::runtime_error("missing value for " + anOption + "!");
+
+        float value = 0.0f;
+        try
+        {
+            value = std::stof(aValue);
+        }
+        catch (const std::exception&)
+        {
+            throw std::runtime_error("invalid value for " + anOption + ": " + aValue);
+        }
+
+        if (!(value > 0.0f))
+            throw std::runtime_error("invalid value for " + anOption + ": " + aValue);
+
+        return value;
+    }
+
+    static DrawSubmissionMode ParseDrawSubmissionMode(const std::string& anOption, const char* aValue)
+    {
+        const std::string value = ParseString(anOption, aValue);
+
+        if (value == "individual")
+            return DrawSubmissionMode::Individual;
+        if (value == "instanced")
+            return DrawSubmissionMode::Instanced;
+        if (value == "indirect")
+            return DrawSubmissionMode::Indirect;
+        if (value == "gpu-culled")
+            return DrawSubmissionMode::GpuCulled;
+
+        throw std::runtime_error("invalid value for " + anOption + ": " + value);
+    }
+
+    static PresentPolicy ParsePresentPolicy(const std::string& anOption, const char* aValue)
+    {
+        const std::string value = ParseString(anOption, aValue);
+
+        if (value == "low-latency")
+            return PresentPolicy::LowLatency;
+        if (value == "throughput")
+            return PresentPolicy::Throughput;
+        if (value == "vsync")
+            return PresentPolicy::VSync;
+        if (value == "power-saver")
+            return PresentPolicy::PowerSaver;
+
+        throw std::runtime_error("invalid value for " + anOption + ": " + value);
+    }
+}
+
+ApplicationSettings ApplicationSettings::FromCommandLine(int anArgumentCount, char* someArguments[])
+{
+    ApplicationSettings settings;
+
+    for (int i = 1; i < anArgumentCount; i++)
+    {
+        const std::string argument = someArguments[i];
+        const char* value = i + 1 < anArgumentCount ? someArguments[i + 1] : nullptr;
+
+        if (argument == "--headless")
+        {
+            settings.myIsHeadless = true;
+        }
+        else if (argument == "--frames")
+        {
+            settings.myFrameCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            i++;
+        }
+        else if (argument == "--warmup-frames")
+        {
+            settings.myWarmupFrameCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            i++;
+        }
+        else if (argument == "--recording-threads")
+        {
+            settings.myRecordingThreadCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            i++;
+        }
+        else if (argument == "--job-threads")
+        {
+            settings.myJobThreadCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            i++;
+        }
+        else if (argument == "--frames-in-flight")
+        {
+            settings.myFramesInFlightCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            if (settings.myFramesInFlightCount < 1 || settings.myFramesInFlightCount > ApplicationSettingsPrivate::ourMaxFramesInFlightCount)
+                throw std::runtime_error("invalid value for " + argument + ": " + value + ", expected 1 to " + std::to_string(ApplicationSettingsPrivate::ourMaxFramesInFlightCount));
+
+            i++;
+        }
+        else if (argument == "--objects")
+        {
+            settings.myObjectCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            i++;
+        }
+        else if (argument == "--draw-mode")
+        {
+            settings.myDrawSubmissionMode = ApplicationSettingsPrivate::ParseDrawSubmissionMode(argument, value);
+            i++;
+        }
+        else if (argument == "--present-policy")
+        {
+            settings.myPresentPolicy = ApplicationSettingsPrivate::ParsePresentPolicy(argument, value);
+            i++;
+        }
+        else if (argument == "--zoom")
+        {
+            settings.myCameraZoom = ApplicationSettingsPrivate::ParsePositiveFloat(argument, value);
+            i++;
+        }
+        else if (argument == "--draw-benchmark")
+        {
+            settings.myIsDrawBenchmark = true;
+        }
+        else if (argument == "--simulate")
+        {
+            settings.myIsSimulating = true;
+        }
+        else if (argument == "--post-process")
+        {
+            settings.myIsPostProcessing = true;
+        }
+        else if (argument == "--dynamic-rendering")
+        {
+            settings.myIsDynamicRendering = true;
+        }
+        else if (argument == "--depth")
+        {
+            settings.myIsDepthTesting = true;
+        }
+        else if (argument == "--msaa")
+        {
+            // Sample counts are the powers of two that VkSampleCountFlagBits can express.
+            settings.myMsaaSampleCount = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            if (settings.myMsaaSampleCount == 0 || settings.myMsaaSampleCount > ApplicationSettingsPrivate::ourMaxMsaaSampleCount || (settings.myMsaaSampleCount & (settings.myMsaaSampleCount - 1)) != 0)
+                throw std::runtime_error("invalid value for " + argument + ": " + value + ", expected a power of two from 1 to " + std::to_string(ApplicationSettingsPrivate::ourMaxMsaaSampleCount));
+
+            i++;
+        }
+        else if (argument == "--msaa-benchmark")
+        {
+            settings.myIsMsaaBenchmark = true;
+        }
+        else if (argument == "--resources")
+        {
+            settings.myResourcesPath = ApplicationSettingsPrivate::ParseString(argument, value);
+            i++;
+        }
+        else if (argument == "--shader-source")
+        {
+            settings.myShaderSourcePath = ApplicationSettingsPrivate::ParseString(argument, value);
+            i++;
+        }
+        else if (argument == "--texture")
+        {
+            settings.myTexturePath = ApplicationSettingsPrivate::ParseString(argument, value);
+            i++;
+        }
+        else if (argument == "--texture-budget")
+        {
+            settings.myTextureBudgetMiB = ApplicationSettingsPrivate::ParseUnsigned(argument, value);
+            i++;
+        }
+        else if (argument == "--gpu-profile-json")
+        {
+            settings.myGpuProfileJsonPath = ApplicationSettingsPrivate::ParseString(argument, value);
+            i++;
+        }
+        else if (argument == "--gpu-profile-csv")
+        {
+            settings.myGpuProfileCsvPath = ApplicationSettingsPrivate::ParseString(argument, value);
+            i++;
+        }
+        else if (argument == "--trace")
+        {
+            settings.myTracePath = ApplicationSettingsPrivate::ParseString(argument, value);
+            i++;
+        }
+        else
+        {
+            throw std::runtime_error("unknown command line argument: " + argument);
+        }
+    }
+
+    // The benchmarks run every configuration of their sweep for this many frames.
+    if ((settings.myIsDrawBenchmark || settings.myIsMsaaBenchmark) && settings.myFrameCount == 0)
+        settings.myFrameCount = ApplicationSettingsPrivate::ourDefaultDrawBenchmarkFrameCount;
+
+    if (settings.myObjectCount == 0 && settings.myIsDrawBenchmark)
+        settings.myObjectCount = ApplicationSettingsPrivate::ourDefaultDrawBenchmarkObjectCount;
+    else if (settings.myObjectCount == 0 && settings.myIsMsaaBenchmark)
+        settings.myObjectCount = ApplicationSettingsPrivate::ourDefaultMsaaBenchmarkObjectCount;
+    else if (settings.myObjectCount == 0)
+        settings.myObjectCount = 1;
+
+    if (settings.myIsHeadless && settings.myFrameCount == 0)
+        settings.myFrameCount = ApplicationSettingsPrivate::ourDefaultHeadlessFrameCount;
+
+    if (settings.myResourcesPath.empty())
+    {
+        std::filesystem::path directory = ApplicationSettingsPrivate::GetExecutableDirectory();
+        if (directory.empty())
+        {
+            directory = std::filesystem::current_path();
+            std::cout << "Could not locate the executable, loading resources from the working directory; use --resources <dir> to choose another" << std::endl;
+        }
+
+        settings.myResourcesPath = (directory / "Resources").generic_string();
+    }
+
+    if (settings.myResourcesPath.back() != '/')
+        settings.myResourcesPath += '/';
+
+    if (!settings.myShaderSourcePath.empty() && settings.myShaderSourcePath.back() != '/')
+        settings.myShaderSourcePath += '/';
+
+    if (settings.myRecordingThreadCount == 0)
+        settings.myRecordingThreadCount = std::clamp(std::thread::hardware_concurrency(), 1u, ApplicationSettingsPrivate::ourMaxDefaultRecordingThreadCount);
+
+    if (settings.myJobThreadCount == 0)
+        settings.myJobThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    return settings;
+}
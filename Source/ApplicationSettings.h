@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+enum class DrawSubmissionMode
+{
+    Individual,
+    Instanced,
+    Indirect,
+    GpuCulled
+};
+
+// Trades input latency, throughput and power through the swap chain's present mode and image count.
+enum class PresentPolicy
+{
+    LowLatency,
+    Throughput,
+    VSync,
+    PowerSaver
+};
+
+struct ApplicationSettings
+{
+    static ApplicationSettings FromCommandLine(int anArgumentCount, char* someArguments[]);
+
+    bool myIsHeadless = false;
+    uint32_t myFrameCount = 0;
+    uint32_t myWarmupFrameCount = 16;
+    uint32_t myRecordingThreadCount = 0;
+    // Threads running jobs, the main thread included.
+    uint32_t myJobThreadCount = 0;
+    uint32_t myFramesInFlightCount = 2;
+    uint32_t myObjectCount = 0;
+    DrawSubmissionMode myDrawSubmissionMode = DrawSubmissionMode::Individual;
+    float myCameraZoom = 1.0f;
+    PresentPolicy myPresentPolicy = PresentPolicy::LowLatency;
+    bool myIsDrawBenchmark = false;
+    bool myIsSimulating = false;
+    // Blurs and vignettes the scene in render graph passes after the main pass.
+    bool myIsPostProcessing = false;
+    // Renders with VK_KHR_dynamic_rendering instead of render pass and framebuffer objects, where supported.
+    bool myIsDynamicRendering = false;
+    bool myIsDepthTesting = false;
+    // Clamped to the largest count the device supports; 1 disables multisampling.
+    uint32_t myMsaaSampleCount = 1;
+    // Renders the scene at every supported sample count and compares GPU time and attachment memory.
+    bool myIsMsaaBenchmark = false;
+    // Directory holding the asset archives, with a trailing separator. Defaults to Resources/ next to the executable.
+    std::string myResourcesPath;
+    // GLSL sources to compile at runtime and watch for changes, with a trailing separator. Empty to use the archive.
+    std::string myShaderSourcePath;
+    // KTX2 texture to stream onto the objects. Empty for a generated checkerboard.
+    std::string myTexturePath;
+    uint32_t myTextureBudgetMiB = 256;
+    std::string myGpuProfileJsonPath;
+    std::string myGpuProfileCsvPath;
+    std::string myTracePath;
+};
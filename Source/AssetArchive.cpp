@@ -0,0 +1,199 @@
+#include "AssetArchive.h"
+#include "AssetArchiveFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AssetArchivePrivate
+{
+    static const AssetArchiveHeader& GetHeader(const uint8_t* someData)
+    {
+        return *reinterpret_cast<const AssetArchiveHeader*>(someData);
+    }
+
+    static const AssetArchiveEntry* GetEntries(const uint8_t* someData)
+    {
+        return reinterpret_cast<const AssetArchiveEntry*>(someData + GetHeader(someData).myIndexOffset);
+    }
+}
+
+AssetArchive::AssetArchive()
+    : myData(nullptr)
+    , mySize(0)
+#ifdef _WIN32
+    , myFileHandle(nullptr)
+    , myMappingHandle(nullptr)
+#endif
+{
+}
+
+AssetArchive::~AssetArchive()
+{
+    Close();
+}
+
+void AssetArchive::Open(const std::string& aPath)
+{
+    Close();
+
+    myPath = aPath;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open asset archive " + aPath + "!");
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("failed to map asset archive " + aPath + "!");
+    }
+
+    myFileHandle = file;
+    myMappingHandle = mapping;
+    mySize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int file = open(aPath.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("failed to open asset archive " + aPath + "!");
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        close(file);
+        throw std::runtime_error("failed to read asset archive " + aPath + "!");
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps the file alive on its own.
+    close(file);
+
+    if (view == MAP_FAILED)
+        throw std::runtime_error("failed to map asset archive " + aPath + "!");
+
+    mySize = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+    myData = static_cast<const uint8_t*>(view);
+
+    try
+    {
+        Validate();
+    }
+    catch (...)
+    {
+        Close();
+        throw;
+    }
+}
+
+void AssetArchive::Close()
+{
+    if (!myData)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(myData);
+    CloseHandle(myMappingHandle);
+    CloseHandle(myFileHandle);
+    myMappingHandle = nullptr;
+    myFileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(myData), mySize);
+#endif
+
+    myData = nullptr;
+    mySize = 0;
+}
+
+bool AssetArchive::Find(const std::string& aName, AssetView& anAssetView) const
+{
+    if (!myData)
+        return false;
+
+    const uint8_t* names = myData + AssetArchivePrivate::GetHeader(myData).myNamesOffset;
+    const AssetArchiveEntry* entriesBegin = AssetArchivePrivate::GetEntries(myData);
+    const AssetArchiveEntry* entriesEnd = entriesBegin + AssetArchivePrivate::GetHeader(myData).myEntryCount;
+
+    const uint64_t nameHash = HashAssetBytes(aName.data(), aName.size());
+    const AssetArchiveEntry* entry = std::lower_bound(entriesBegin, entriesEnd, nameHash, [](const AssetArchiveEntry& anEntry, uint64_t aHash) { return anEntry.myNameHash < aHash; });
+
+    // Names are compared as well, in case two of them share a hash.
+    for (; entry != entriesEnd && entry->myNameHash == nameHash; ++entry)
+    {
+        if (entry->myNameLength != aName.size() || std::memcmp(names + entry->myNameOffset, aName.data(), aName.size()) != 0)
+            continue;
+
+        anAssetView.myData = myData + entry->myDataOffset;
+        anAssetView.mySize = static_cast<size_t>(entry->myDataSize);
+        anAssetView.myContentHash = entry->myContentHash;
+        return true;
+    }
+
+    return false;
+}
+
+AssetView AssetArchive::Get(const std::string& aName) const
+{
+    AssetView assetView;
+    if (!Find(aName, assetView))
+        throw std::runtime_error("failed to find asset " + aName + " in " + myPath + "!");
+
+    return assetView;
+}
+
+uint32_t AssetArchive::GetAssetCount() const
+{
+    return myData ? AssetArchivePrivate::GetHeader(myData).myEntryCount : 0;
+}
+
+void AssetArchive::Validate() const
+{
+    if (mySize < sizeof(AssetArchiveHeader))
+        throw std::runtime_error("asset archive " + myPath + " is truncated!");
+
+    const AssetArchiveHeader& header = AssetArchivePrivate::GetHeader(myData);
+    if (header.myMagic != ourAssetArchiveMagic || header.myVersion != ourAssetArchiveVersion)
+        throw std::runtime_error("asset archive " + myPath + " has an unsupported format!");
+
+    const uint64_t indexEnd = header.myIndexOffset + static_cast<uint64_t>(header.myEntryCount) * sizeof(AssetArchiveEntry);
+    if (header.myIndexOffset % alignof(AssetArchiveEntry) != 0 || indexEnd > mySize || header.myNamesOffset > mySize)
+        throw std::runtime_error("asset archive " + myPath + " has a corrupt index!");
+
+    const AssetArchiveEntry* entries = AssetArchivePrivate::GetEntries(myData);
+    for (uint32_t i = 0; i < header.myEntryCount; i++)
+    {
+        const AssetArchiveEntry& entry = entries[i];
+
+        const bool isSorted = i == 0 || entries[i - 1].myNameHash <= entry.myNameHash;
+        const bool isNameInside = header.myNamesOffset + entry.myNameOffset + entry.myNameLength <= mySize;
+        const bool isDataInside = entry.myDataOffset <= mySize && entry.myDataSize <= mySize - entry.myDataOffset;
+        if (!isSorted || !isNameInside || !isDataInside || entry.myDataOffset % ourAssetArchiveDataAlignment != 0)
+            throw std::runtime_error("asset archive " + myPath + " has a corrupt index!");
+
+#ifndef NDEBUG
+        // Hashing touches every page, so release builds trust the packer.
+        if (HashAssetBytes(myData + entry.myDataOffset, static_cast<size_t>(entry.myDataSize)) != entry.myContentHash)
+            throw std::runtime_error("asset archive " + myPath + " has corrupt contents!");
+#endif
+    }
+}
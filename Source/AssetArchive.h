@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// An asset's bytes inside the mapped archive. Valid until the archive is closed.
+struct AssetView
+{
+    const void* myData = nullptr;
+    size_t mySize = 0;
+    uint64_t myContentHash = 0;
+};
+
+// Read-only archive built by the AssetPacker tool. The file is memory-mapped once and assets are returned as views
+// into the mapping, so nothing is copied and untouched assets are never paged in.
+// Lookups only read the mapping and can run on several threads at once.
+class AssetArchive
+{
+public:
+    AssetArchive();
+    ~AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    void Open(const std::string& aPath);
+    void Close();
+
+    // Binary-searches the index by name hash; returns false when the archive has no asset with that name.
+    bool Find(const std::string& aName, AssetView& anAssetView) const;
+    AssetView Get(const std::string& aName) const;
+
+    uint32_t GetAssetCount() const;
+
+private:
+    void Validate() const;
+
+    std::string myPath;
+    const uint8_t* myData;
+    size_t mySize;
+#ifdef _WIN32
+    void* myFileHandle;
+    void* myMappingHandle;
+#endif
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of an asset archive, shared by AssetArchive and the AssetPacker tool. All fields are little-endian.
+// The file holds the header, the index sorted by name hash, the names, then the data of every entry aligned to
+// ourAssetArchiveDataAlignment so SPIR-V words can be read straight from the mapping.
+static constexpr uint32_t ourAssetArchiveMagic = 0x41564B48; // "HKVA"
+static constexpr uint32_t ourAssetArchiveVersion = 1;
+static constexpr uint64_t ourAssetArchiveDataAlignment = 16;
+
+struct AssetArchiveHeader
+{
+    uint32_t myMagic;
+    uint32_t myVersion;
+    uint32_t myEntryCount;
+    uint32_t myReserved;
+    uint64_t myIndexOffset;
+    uint64_t myNamesOffset;
+};
+
+struct AssetArchiveEntry
+{
+    uint64_t myNameHash;
+    uint64_t myContentHash;
+    uint64_t myDataOffset;
+    uint64_t myDataSize;
+    uint32_t myNameOffset;
+    uint32_t myNameLength;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 32, "AssetArchiveHeader must match the file layout");
+static_assert(sizeof(AssetArchiveEntry) == 40, "AssetArchiveEntry must match the file layout");
+
+// 64-bit FNV-1a, used for both names and contents.
+inline uint64_t HashAssetBytes(const void* someBytes, size_t aSize)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(someBytes);
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < aSize; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
@@ -0,0 +1,216 @@
+#include "BindlessDescriptors.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace BindlessDescriptorsPrivate
+{
+    static constexpr uint32_t ourTypeCount = static_cast<uint32_t>(BindlessResourceType::Count);
+
+    // Upper bounds; devices with lower update-after-bind limits get fewer handles.
+    static constexpr uint32_t ourMaxStorageBufferCount = 4096;
+    static constexpr uint32_t ourMaxSampledImageCount = 16384;
+    static constexpr uint32_t ourMaxSamplerCount = 256;
+    // Left for the frame uniform buffer and the color attachments, which share a stage's resource limit with the set.
+    static constexpr uint32_t ourReservedStageResourceCount = 8;
+
+    static constexpr VkDescriptorType ourDescriptorTypes[ourTypeCount] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER };
+}
+
+BindlessDescriptors::BindlessDescriptors()
+    : myVkDevice(nullptr)
+    , myVkDescriptorSetLayout(nullptr)
+    , myVkDescriptorPool(nullptr)
+    , myVkDescriptorSet(nullptr)
+{
+}
+
+void BindlessDescriptors::Create(VkDevice aDevice, const VkPhysicalDeviceDescriptorIndexingProperties& someProperties)
+{
+    using namespace BindlessDescriptorsPrivate;
+
+    myVkDevice = aDevice;
+
+    myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::StorageBuffer)].myCapacity = std::min({ ourMaxStorageBufferCount, someProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, someProperties.maxDescriptorSetUpdateAfterBindStorageBuffers });
+    myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::SampledImage)].myCapacity = std::min({ ourMaxSampledImageCount, someProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, someProperties.maxDescriptorSetUpdateAfterBindSampledImages });
+    myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::Sampler)].myCapacity = std::min({ ourMaxSamplerCount, someProperties.maxPerStageDescriptorUpdateAfterBindSamplers, someProperties.maxDescriptorSetUpdateAfterBindSamplers });
+
+    // Every binding is visible to every stage, so storage buffers and sampled images must fit in one stage's resource
+    // limit together. Samplers do not count towards it. Shrink both in proportion when they do not fit.
+    if (someProperties.maxPerStageUpdateAfterBindResources < ourReservedStageResourceCount + 2)
+        throw std::runtime_error("too few update-after-bind resources per stage for bindless descriptors!");
+
+    uint32_t& storageBufferCapacity = myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::StorageBuffer)].myCapacity;
+    uint32_t& sampledImageCapacity = myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::SampledImage)].myCapacity;
+    const uint64_t resourceCount = static_cast<uint64_t>(storageBufferCapacity) + sampledImageCapacity;
+    const uint32_t resourceBudget = someProperties.maxPerStageUpdateAfterBindResources - ourReservedStageResourceCount;
+    if (resourceCount > resourceBudget)
+    {
+        storageBufferCapacity = std::max(1u, static_cast<uint32_t>(storageBufferCapacity * static_cast<uint64_t>(resourceBudget) / resourceCount));
+        sampledImageCapacity = std::min(sampledImageCapacity, resourceBudget - storageBufferCapacity);
+    }
+
+    if (storageBufferCapacity == 0 || sampledImageCapacity == 0 || myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::Sampler)].myCapacity == 0)
+        throw std::runtime_error("bindless descriptors do not fit in the device's update-after-bind limits!");
+
+    VkDescriptorSetLayoutBinding bindings[ourTypeCount] = {};
+    VkDescriptorBindingFlags bindingFlags[ourTypeCount] = {};
+    VkDescriptorPoolSize poolSizes[ourTypeCount] = {};
+    for (uint32_t i = 0; i < ourTypeCount; i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = ourDescriptorTypes[i];
+        bindings[i].descriptorCount = myHandleAllocators[i].myCapacity;
+        bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+
+        // Unused handles are never written, and writes may land while frames using other handles are in flight.
+        bindingFlags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+        poolSizes[i].type = ourDescriptorTypes[i];
+        poolSizes[i].descriptorCount = myHandleAllocators[i].myCapacity;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = ourTypeCount;
+    bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = ourTypeCount;
+    layoutInfo.pBindings = bindings;
+
+    if (vkCreateDescriptorSetLayout(myVkDevice, &layoutInfo, nullptr, &myVkDescriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create bindless descriptor set layout!");
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = ourTypeCount;
+    poolInfo.pPoolSizes = poolSizes;
+
+    if (vkCreateDescriptorPool(myVkDevice, &poolInfo, nullptr, &myVkDescriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+
+    VkDescriptorSetAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = myVkDescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &myVkDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(myVkDevice, &allocateInfo, &myVkDescriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+}
+
+void BindlessDescriptors::Destroy()
+{
+    if (!myVkDevice)
+        return;
+
+    vkDestroyDescriptorPool(myVkDevice, myVkDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(myVkDevice, myVkDescriptorSetLayout, nullptr);
+
+    for (HandleAllocator& handleAllocator : myHandleAllocators)
+        handleAllocator = HandleAllocator();
+
+    myVkDescriptorSet = nullptr;
+    myVkDescriptorPool = nullptr;
+    myVkDescriptorSetLayout = nullptr;
+    myVkDevice = nullptr;
+}
+
+uint32_t BindlessDescriptors::AddStorageBuffer(VkBuffer aBuffer, VkDeviceSize anOffset, VkDeviceSize aRange)
+{
+    const uint32_t handle = AllocateHandle(BindlessResourceType::StorageBuffer);
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = aBuffer;
+    bufferInfo.offset = anOffset;
+    bufferInfo.range = aRange;
+
+    WriteDescriptor(BindlessResourceType::StorageBuffer, handle, &bufferInfo, nullptr);
+    return handle;
+}
+
+uint32_t BindlessDescriptors::AddSampledImage(VkImageView anImageView, VkImageLayout aLayout)
+{
+    const uint32_t handle = AllocateHandle(BindlessResourceType::SampledImage);
+
+    VkDescriptorImageInfo imageInfo = {};
+    imageInfo.imageView = anImageView;
+    imageInfo.imageLayout = aLayout;
+
+    WriteDescriptor(BindlessResourceType::SampledImage, handle, nullptr, &imageInfo);
+    return handle;
+}
+
+uint32_t BindlessDescriptors::AddSampler(VkSampler aSampler)
+{
+    const uint32_t handle = AllocateHandle(BindlessResourceType::Sampler);
+
+    VkDescriptorImageInfo imageInfo = {};
+    imageInfo.sampler = aSampler;
+
+    WriteDescriptor(BindlessResourceType::Sampler, handle, nullptr, &imageInfo);
+    return handle;
+}
+
+void BindlessDescriptors::Remove(BindlessResourceType aType, uint32_t aHandle, uint64_t aLastFrameValue)
+{
+    if (aHandle == ourInvalidHandle)
+        return;
+
+    myHandleAllocators[static_cast<uint32_t>(aType)].myRetiredHandles.push_back({ aHandle, aLastFrameValue });
+}
+
+void BindlessDescriptors::Update(uint64_t aCompletedFrameValue)
+{
+    for (HandleAllocator& handleAllocator : myHandleAllocators)
+    {
+        while (!handleAllocator.myRetiredHandles.empty() && handleAllocator.myRetiredHandles.front().myLastFrameValue <= aCompletedFrameValue)
+        {
+            handleAllocator.myFreeHandles.push_back(handleAllocator.myRetiredHandles.front().myHandle);
+            handleAllocator.myRetiredHandles.pop_front();
+        }
+    }
+}
+
+void BindlessDescriptors::Bind(VkCommandBuffer aCommandBuffer, VkPipelineBindPoint aBindPoint, VkPipelineLayout aPipelineLayout) const
+{
+    vkCmdBindDescriptorSets(aCommandBuffer, aBindPoint, aPipelineLayout, 0, 1, &myVkDescriptorSet, 0, nullptr);
+}
+
+uint32_t BindlessDescriptors::AllocateHandle(BindlessResourceType aType)
+{
+    HandleAllocator& handleAllocator = myHandleAllocators[static_cast<uint32_t>(aType)];
+
+    if (!handleAllocator.myFreeHandles.empty())
+    {
+        const uint32_t handle = handleAllocator.myFreeHandles.back();
+        handleAllocator.myFreeHandles.pop_back();
+        return handle;
+    }
+
+    if (handleAllocator.myNextHandle == handleAllocator.myCapacity)
+        throw std::runtime_error("failed to allocate a bindless descriptor handle!");
+
+    return handleAllocator.myNextHandle++;
+}
+
+void BindlessDescriptors::WriteDescriptor(BindlessResourceType aType, uint32_t aHandle, const VkDescriptorBufferInfo* aBufferInfo, const VkDescriptorImageInfo* anImageInfo)
+{
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = myVkDescriptorSet;
+    write.dstBinding = static_cast<uint32_t>(aType);
+    write.dstArrayElement = aHandle;
+    write.descriptorCount = 1;
+    write.descriptorType = BindlessDescriptorsPrivate::ourDescriptorTypes[static_cast<uint32_t>(aType)];
+    write.pBufferInfo = aBufferInfo;
+    write.pImageInfo = anImageInfo;
+
+    vkUpdateDescriptorSets(myVkDevice, 1, &write, 0, nullptr);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+enum class BindlessResourceType : uint32_t
+{
+    StorageBuffer,
+    SampledImage,
+    Sampler,
+    Count
+};
+
+// One update-after-bind descriptor set holding every storage buffer, sampled image and sampler the shaders may use,
+// in bindings 0, 1 and 2 respectively. Resources are addressed by stable integer handles that shaders receive through
+// push constants, so command buffers bind the set once instead of once per draw.
+// Adding and removing resources is not thread-safe; Bind can be recorded from any thread.
+class BindlessDescriptors
+{
+public:
+    static constexpr uint32_t ourInvalidHandle = UINT32_MAX;
+
+    BindlessDescriptors();
+
+    void Create(VkDevice aDevice, const VkPhysicalDeviceDescriptorIndexingProperties& someProperties);
+    void Destroy();
+
+    // The descriptor is written immediately; update-after-bind makes that legal while other frames are in flight.
+    uint32_t AddStorageBuffer(VkBuffer aBuffer, VkDeviceSize anOffset = 0, VkDeviceSize aRange = VK_WHOLE_SIZE);
+    uint32_t AddSampledImage(VkImageView anImageView, VkImageLayout aLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t AddSampler(VkSampler aSampler);
+
+    // The handle is handed out again once Update reports aLastFrameValue, the last frame that may read it, as completed.
+    void Remove(BindlessResourceType aType, uint32_t aHandle, uint64_t aLastFrameValue);
+    void Update(uint64_t aCompletedFrameValue);
+
+    void Bind(VkCommandBuffer aCommandBuffer, VkPipelineBindPoint aBindPoint, VkPipelineLayout aPipelineLayout) const;
+
+    VkDescriptorSetLayout GetVkDescriptorSetLayout() const { return myVkDescriptorSetLayout; }
+    uint32_t GetCapacity(BindlessResourceType aType) const { return myHandleAllocators[static_cast<uint32_t>(aType)].myCapacity; }
+
+private:
+    struct RetiredHandle
+    {
+        uint32_t myHandle;
+        uint64_t myLastFrameValue;
+    };
+
+    // Hands out the lowest never-used handle unless a freed one is available.
+    struct HandleAllocator
+    {
+        std::vector<uint32_t> myFreeHandles;
+        std::deque<RetiredHandle> myRetiredHandles;
+        uint32_t myNextHandle = 0;
+        uint32_t myCapacity = 0;
+    };
+
+    uint32_t AllocateHandle(BindlessResourceType aType);
+    void WriteDescriptor(BindlessResourceType aType, uint32_t aHandle, const VkDescriptorBufferInfo* aBufferInfo, const VkDescriptorImageInfo* anImageInfo);
+
+    VkDevice myVkDevice;
+    VkDescriptorSetLayout myVkDescriptorSetLayout;
+    VkDescriptorPool myVkDescriptorPool;
+    VkDescriptorSet myVkDescriptorSet;
+    HandleAllocator myHandleAllocators[static_cast<uint32_t>(BindlessResourceType::Count)];
+};
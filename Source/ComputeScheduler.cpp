@@ -0,0 +1,106 @@
+#include "ComputeScheduler.h"
+#include "CpuTracer.h"
+
+#include <stdexcept>
+
+ComputeScheduler::ComputeScheduler()
+    : myVkDevice(nullptr)
+    , myVkComputeQueue(nullptr)
+    , myVkTimelineSemaphore(nullptr)
+{
+}
+
+void ComputeScheduler::Create(VkDevice aDevice, VkQueue aComputeQueue, uint32_t aComputeFamilyIndex, uint32_t aFrameCount)
+{
+    myVkDevice = aDevice;
+    myVkComputeQueue = aComputeQueue;
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = aComputeFamilyIndex;
+
+    VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {};
+    semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphoreTypeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+    if (vkCreateSemaphore(myVkDevice, &semaphoreInfo, nullptr, &myVkTimelineSemaphore) != VK_SUCCESS)
+        throw std::runtime_error("failed to create compute timeline semaphore!");
+
+    myFrameBatches.resize(aFrameCount);
+
+    for (FrameBatch& frameBatch : myFrameBatches)
+    {
+        if (vkCreateCommandPool(myVkDevice, &poolInfo, nullptr, &frameBatch.myVkCommandPool) != VK_SUCCESS)
+            throw std::runtime_error("failed to create compute command pool!");
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = frameBatch.myVkCommandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(myVkDevice, &allocInfo, &frameBatch.myVkCommandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate compute command buffer!");
+    }
+}
+
+void ComputeScheduler::Destroy()
+{
+    for (FrameBatch& frameBatch : myFrameBatches)
+        vkDestroyCommandPool(myVkDevice, frameBatch.myVkCommandPool, nullptr);
+
+    myFrameBatches.clear();
+
+    if (myVkTimelineSemaphore)
+        vkDestroySemaphore(myVkDevice, myVkTimelineSemaphore, nullptr);
+
+    myVkTimelineSemaphore = nullptr;
+}
+
+VkCommandBuffer ComputeScheduler::BeginFrame(uint32_t aFrameIndex)
+{
+    FrameBatch& frameBatch = myFrameBatches[aFrameIndex];
+
+    vkResetCommandPool(myVkDevice, frameBatch.myVkCommandPool, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(frameBatch.myVkCommandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording compute command buffer!");
+
+    return frameBatch.myVkCommandBuffer;
+}
+
+void ComputeScheduler::Submit(uint32_t aFrameIndex, uint64_t aTimelineValue)
+{
+    CPU_TRACE_ZONE("ComputeSubmit");
+
+    FrameBatch& frameBatch = myFrameBatches[aFrameIndex];
+
+    if (vkEndCommandBuffer(frameBatch.myVkCommandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record compute command buffer!");
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &aTimelineValue;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &frameBatch.myVkCommandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &myVkTimelineSemaphore;
+
+    if (vkQueueSubmit(myVkComputeQueue, 1, &submitInfo, nullptr) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit compute command buffer!");
+}
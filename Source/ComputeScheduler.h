@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+// Records and submits one batch of work per frame on the compute queue. Each batch signals the queue's timeline
+// semaphore with its frame's value, and the graphics submission of the same frame waits on that value, so compute work
+// for a frame overlaps the graphics work of the frames before it. Not thread-safe.
+class ComputeScheduler
+{
+public:
+    ComputeScheduler();
+
+    void Create(VkDevice aDevice, VkQueue aComputeQueue, uint32_t aComputeFamilyIndex, uint32_t aFrameCount);
+    void Destroy();
+
+    // Resets and begins the frame's command buffer. Must be called after the frame slot's previous graphics submission
+    // has completed: that submission waited on the slot's previous batch, so the batch has finished as well.
+    VkCommandBuffer BeginFrame(uint32_t aFrameIndex);
+
+    // Submits the frame's batch, which signals the timeline semaphore with aTimelineValue once it completes.
+    // Values must increase from one submission to the next.
+    void Submit(uint32_t aFrameIndex, uint64_t aTimelineValue);
+
+    VkSemaphore GetVkTimelineSemaphore() const { return myVkTimelineSemaphore; }
+
+private:
+    struct FrameBatch
+    {
+        VkCommandPool myVkCommandPool = nullptr;
+        VkCommandBuffer myVkCommandBuffer = nullptr;
+    };
+
+    VkDevice myVkDevice;
+    VkQueue myVkComputeQueue;
+    VkSemaphore myVkTimelineSemaphore;
+    std::vector<FrameBatch> myFrameBatches;
+};
@@ -0,0 +1,182 @@
+#include "CpuTracer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace CpuTracerPrivate
+{
+    static constexpr uint64_t ourRingBufferSize = 1 << 16;
+
+    // Every field is atomic so the dumping thread can read slots that are being overwritten without a data race.
+    // Torn events are detected afterwards by re-reading the write index.
+    struct ZoneEvent
+    {
+        std::atomic<const char*> myName{ nullptr };
+        std::atomic<uint64_t> myStartNs{ 0 };
+        std::atomic<uint64_t> myEndNs{ 0 };
+    };
+
+    struct ThreadRingBuffer
+    {
+        std::array<ZoneEvent, ourRingBufferSize> myEvents;
+        std::atomic<uint64_t> myWriteIndex{ 0 };
+        std::string myThreadName;
+        uint32_t myThreadId = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex myMutex;
+        std::vector<std::shared_ptr<ThreadRingBuffer>> myBuffers;
+    };
+
+    static Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    static ThreadRingBuffer& GetThreadRingBuffer()
+    {
+        thread_local std::shared_ptr<ThreadRingBuffer> threadRingBuffer;
+        if (!threadRingBuffer)
+        {
+            threadRingBuffer = std::make_shared<ThreadRingBuffer>();
+
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.myMutex);
+            threadRingBuffer->myThreadId = static_cast<uint32_t>(registry.myBuffers.size());
+            threadRingBuffer->myThreadName = "Thread " + std::to_string(threadRingBuffer->myThreadId);
+            registry.myBuffers.push_back(threadRingBuffer);
+        }
+
+        return *threadRingBuffer;
+    }
+
+    static void WriteEscaped(std::ostream& aStream, const std::string& aString)
+    {
+        for (char character : aString)
+        {
+            if (character == '"' || character == '\\')
+                aStream << '\\';
+
+            aStream << character;
+        }
+    }
+}
+
+std::atomic<bool> CpuTracer::ourIsEnabled{ false };
+
+void CpuTracer::SetThreadName(const std::string& aName)
+{
+    if (!IsEnabled())
+        return;
+
+    CpuTracerPrivate::ThreadRingBuffer& threadRingBuffer = CpuTracerPrivate::GetThreadRingBuffer();
+
+    std::lock_guard<std::mutex> lock(CpuTracerPrivate::GetRegistry().myMutex);
+    threadRingBuffer.myThreadName = aName;
+}
+
+uint64_t CpuTracer::GetTimestamp()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void CpuTracer::RecordZone(const char* aName, uint64_t aStartNs, uint64_t anEndNs)
+{
+    CpuTracerPrivate::ThreadRingBuffer& threadRingBuffer = CpuTracerPrivate::GetThreadRingBuffer();
+
+    const uint64_t writeIndex = threadRingBuffer.myWriteIndex.load(std::memory_order_relaxed);
+    CpuTracerPrivate::ZoneEvent& event = threadRingBuffer.myEvents[writeIndex % CpuTracerPrivate::ourRingBufferSize];
+
+    event.myName.store(aName, std::memory_order_relaxed);
+    event.myStartNs.store(aStartNs, std::memory_order_relaxed);
+    event.myEndNs.store(anEndNs, std::memory_order_relaxed);
+
+    threadRingBuffer.myWriteIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+void CpuTracer::WriteChromeTrace(const std::string& aPath)
+{
+    struct CollectedEvent
+    {
+        const char* myName;
+        uint64_t myStartNs;
+        uint64_t myEndNs;
+        uint32_t myThreadId;
+    };
+
+    std::vector<CollectedEvent> events;
+    std::vector<std::pair<uint32_t, std::string>> threadNames;
+
+    {
+        CpuTracerPrivate::Registry& registry = CpuTracerPrivate::GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.myMutex);
+
+        for (const std::shared_ptr<CpuTracerPrivate::ThreadRingBuffer>& threadRingBuffer : registry.myBuffers)
+        {
+            threadNames.emplace_back(threadRingBuffer->myThreadId, threadRingBuffer->myThreadName);
+
+            const uint64_t endIndex = threadRingBuffer->myWriteIndex.load(std::memory_order_acquire);
+            const uint64_t startIndex = endIndex > CpuTracerPrivate::ourRingBufferSize ? endIndex - CpuTracerPrivate::ourRingBufferSize : 0;
+            const size_t firstEvent = events.size();
+
+            for (uint64_t i = startIndex; i < endIndex; i++)
+            {
+                const CpuTracerPrivate::ZoneEvent& event = threadRingBuffer->myEvents[i % CpuTracerPrivate::ourRingBufferSize];
+                events.push_back({ event.myName.load(std::memory_order_relaxed), event.myStartNs.load(std::memory_order_relaxed), event.myEndNs.load(std::memory_order_relaxed), threadRingBuffer->myThreadId });
+            }
+
+            // Drop the slots the owning thread overwrote while they were being copied, including the one it may be writing right now.
+            const uint64_t newEndIndex = threadRingBuffer->myWriteIndex.load(std::memory_order_acquire) + 1;
+            if (newEndIndex > startIndex + CpuTracerPrivate::ourRingBufferSize)
+            {
+                const size_t overwrittenCount = static_cast<size_t>(std::min(newEndIndex - (startIndex + CpuTracerPrivate::ourRingBufferSize), endIndex - startIndex));
+                events.erase(events.begin() + firstEvent, events.begin() + firstEvent + overwrittenCount);
+            }
+        }
+    }
+
+    uint64_t baseNs = UINT64_MAX;
+    for (const CollectedEvent& event : events)
+        baseNs = std::min(baseNs, event.myStartNs);
+
+    std::ofstream file(aPath, std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open trace output " + aPath);
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool isFirstEvent = true;
+    for (const std::pair<uint32_t, std::string>& threadName : threadNames)
+    {
+        file << (isFirstEvent ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadName.first << ",\"args\":{\"name\":\"";
+        CpuTracerPrivate::WriteEscaped(file, threadName.second);
+        file << "\"}}";
+        isFirstEvent = false;
+    }
+
+    for (const CollectedEvent& event : events)
+    {
+        if (!event.myName || event.myEndNs < event.myStartNs)
+            continue;
+
+        file << (isFirstEvent ? "\n" : ",\n") << "{\"name\":\"";
+        CpuTracerPrivate::WriteEscaped(file, event.myName);
+        file << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.myThreadId
+            << ",\"ts\":" << static_cast<double>(event.myStartNs - baseNs) / 1000.0
+            << ",\"dur\":" << static_cast<double>(event.myEndNs - event.myStartNs) / 1000.0 << "}";
+        isFirstEvent = false;
+    }
+
+    file << "\n]}\n";
+}
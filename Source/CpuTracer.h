@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define CPU_TRACE_CONCATENATE_INNER(aFirst, aSecond) aFirst##aSecond
+#define CPU_TRACE_CONCATENATE(aFirst, aSecond) CPU_TRACE_CONCATENATE_INNER(aFirst, aSecond)
+#define CPU_TRACE_ZONE(aName) CpuTraceZone CPU_TRACE_CONCATENATE(cpuTraceZone, __LINE__)(aName)
+
+// Zones are written into a fixed-size ring buffer owned by the recording thread, so recording never locks.
+// Only the first zone recorded on a thread takes a lock, to register its buffer for WriteChromeTrace.
+class CpuTracer
+{
+public:
+    static void SetEnabled(bool anIsEnabled) { ourIsEnabled.store(anIsEnabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return ourIsEnabled.load(std::memory_order_relaxed); }
+
+    static void SetThreadName(const std::string& aName);
+    static uint64_t GetTimestamp();
+    static void RecordZone(const char* aName, uint64_t aStartNs, uint64_t anEndNs);
+
+    // Writes every zone still held by the ring buffers as Chrome/Perfetto trace-event JSON.
+    static void WriteChromeTrace(const std::string& aPath);
+
+private:
+    static std::atomic<bool> ourIsEnabled;
+};
+
+class CpuTraceZone
+{
+public:
+    explicit CpuTraceZone(const char* aName)
+        : myName(aName)
+        , myStartNs(CpuTracer::IsEnabled() ? CpuTracer::GetTimestamp() : 0)
+    {
+    }
+
+    ~CpuTraceZone()
+    {
+        if (myStartNs != 0)
+            CpuTracer::RecordZone(myName, myStartNs, CpuTracer::GetTimestamp());
+    }
+
+    CpuTraceZone(const CpuTraceZone&) = delete;
+    CpuTraceZone& operator=(const CpuTraceZone&) = delete;
+
+private:
+    const char* myName;
+    uint64_t myStartNs;
+};
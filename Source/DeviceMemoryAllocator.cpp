@@ -0,0 +1,299 @@
+#include "DeviceMemoryAllocator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+namespace DeviceMemoryAllocatorPrivate
+{
+    static constexpr VkDeviceSize ourLargeHeapBlockSize = 64ull * 1024 * 1024;
+    static constexpr VkDeviceSize ourSmallHeapSize = 1024ull * 1024 * 1024;
+    static constexpr uint32_t ourPoolKindCount = 2;
+
+    static double ToMegabytes(VkDeviceSize aSize)
+    {
+        return static_cast<double>(aSize) / (1024.0 * 1024.0);
+    }
+}
+
+struct MemoryBlock
+{
+    explicit MemoryBlock(VkDeviceSize aSize) : myAllocator(aSize) {}
+
+    TlsfAllocator myAllocator;
+    VkDeviceMemory myVkDeviceMemory = nullptr;
+    void* myMappedData = nullptr;
+    uint32_t myMemoryTypeIndex = 0;
+    uint32_t myPoolIndex = 0;
+    bool myIsDedicated = false;
+};
+
+DeviceMemoryAllocator::DeviceMemoryAllocator()
+    : myVkDevice(nullptr)
+    , myVkMemoryProperties()
+    , myBufferImageGranularity(1)
+    , myMaxAllocationCount(0)
+    , myDeviceAllocationCount(0)
+{
+}
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator() = default;
+
+void DeviceMemoryAllocator::Create(VkDevice aDevice, VkPhysicalDevice aPhysicalDevice)
+{
+    myVkDevice = aDevice;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(aPhysicalDevice, &properties);
+    vkGetPhysicalDeviceMemoryProperties(aPhysicalDevice, &myVkMemoryProperties);
+
+    myBufferImageGranularity = properties.limits.bufferImageGranularity;
+    myMaxAllocationCount = properties.limits.maxMemoryAllocationCount;
+    myPools.resize(myVkMemoryProperties.memoryTypeCount * DeviceMemoryAllocatorPrivate::ourPoolKindCount);
+}
+
+void DeviceMemoryAllocator::Destroy()
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    for (Pool& pool : myPools)
+    {
+        for (std::unique_ptr<MemoryBlock>& block : pool.myBlocks)
+        {
+            if (block->myMappedData)
+                vkUnmapMemory(myVkDevice, block->myVkDeviceMemory);
+
+            vkFreeMemory(myVkDevice, block->myVkDeviceMemory, nullptr);
+        }
+    }
+
+    myPools.clear();
+    myDeviceAllocationCount = 0;
+}
+
+MemoryAllocation DeviceMemoryAllocator::Allocate(const VkMemoryRequirements& someRequirements, VkMemoryPropertyFlags someProperties, MemoryAllocationKind aKind)
+{
+    const uint32_t memoryTypeIndex = FindMemoryType(someRequirements.memoryTypeBits, someProperties);
+
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    const uint32_t poolIndex = GetPoolIndex(memoryTypeIndex, aKind);
+    const VkDeviceSize preferredBlockSize = GetPreferredBlockSize(memoryTypeIndex);
+
+    MemoryBlock* block = nullptr;
+    uint64_t offset = 0;
+    uint32_t handle = TlsfAllocator::ourInvalidHandle;
+
+    if (someRequirements.size > preferredBlockSize / 2)
+    {
+        block = CreateBlock(poolIndex, memoryTypeIndex, someRequirements.size, true);
+        handle = block->myAllocator.Allocate(someRequirements.size, someRequirements.alignment, offset);
+    }
+    else
+    {
+        for (std::unique_ptr<MemoryBlock>& existingBlock : myPools[poolIndex].myBlocks)
+        {
+            if (existingBlock->myIsDedicated)
+                continue;
+
+            handle = existingBlock->myAllocator.Allocate(someRequirements.size, someRequirements.alignment, offset);
+            if (handle != TlsfAllocator::ourInvalidHandle)
+            {
+                block = existingBlock.get();
+                break;
+            }
+        }
+
+        if (!block)
+        {
+            block = CreateBlock(poolIndex, memoryTypeIndex, preferredBlockSize, false);
+            handle = block->myAllocator.Allocate(someRequirements.size, someRequirements.alignment, offset);
+        }
+    }
+
+    if (handle == TlsfAllocator::ourInvalidHandle)
+        throw std::runtime_error("failed to sub-allocate device memory!");
+
+    MemoryAllocation allocation;
+    allocation.myVkDeviceMemory = block->myVkDeviceMemory;
+    allocation.myOffset = offset;
+    allocation.mySize = someRequirements.size;
+    allocation.myMappedData = block->myMappedData ? static_cast<char*>(block->myMappedData) + offset : nullptr;
+    allocation.myBlock = block;
+    allocation.myHandle = handle;
+
+    return allocation;
+}
+
+MemoryAllocation DeviceMemoryAllocator::AllocateForBuffer(VkBuffer aBuffer, VkMemoryPropertyFlags someProperties)
+{
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(myVkDevice, aBuffer, &memoryRequirements);
+
+    MemoryAllocation allocation = Allocate(memoryRequirements, someProperties, MemoryAllocationKind::Linear);
+    vkBindBufferMemory(myVkDevice, aBuffer, allocation.myVkDeviceMemory, allocation.myOffset);
+
+    return allocation;
+}
+
+MemoryAllocation DeviceMemoryAllocator::AllocateForImage(VkImage anImage, VkMemoryPropertyFlags someProperties)
+{
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(myVkDevice, anImage, &memoryRequirements);
+
+    MemoryAllocation allocation = Allocate(memoryRequirements, someProperties, MemoryAllocationKind::Optimal);
+    vkBindImageMemory(myVkDevice, anImage, allocation.myVkDeviceMemory, allocation.myOffset);
+
+    return allocation;
+}
+
+void DeviceMemoryAllocator::Free(MemoryAllocation& anAllocation)
+{
+    if (!anAllocation.myBlock)
+        return;
+
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    MemoryBlock* block = anAllocation.myBlock;
+    block->myAllocator.Free(anAllocation.myHandle);
+    anAllocation = MemoryAllocation();
+
+    if (!block->myAllocator.IsEmpty())
+        return;
+
+    // Keep a single empty block around so a pool that oscillates around a block boundary does not thrash.
+    const Pool& pool = myPools[block->myPoolIndex];
+    const size_t emptyBlockCount = std::count_if(pool.myBlocks.begin(), pool.myBlocks.end(), [](const std::unique_ptr<MemoryBlock>& aBlock)
+    {
+        return !aBlock->myIsDedicated && aBlock->myAllocator.IsEmpty();
+    });
+
+    if (block->myIsDedicated || emptyBlockCount > 1)
+        DestroyBlock(block);
+}
+
+std::vector<MemoryTypeStatistics> DeviceMemoryAllocator::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(myMutex);
+
+    std::vector<MemoryTypeStatistics> statistics(myVkMemoryProperties.memoryTypeCount);
+    for (const Pool& pool : myPools)
+    {
+        for (const std::unique_ptr<MemoryBlock>& block : pool.myBlocks)
+        {
+            MemoryTypeStatistics& typeStatistics = statistics[block->myMemoryTypeIndex];
+            typeStatistics.myBlockCount++;
+            typeStatistics.myAllocationCount += block->myAllocator.GetAllocationCount();
+            typeStatistics.myBlockBytes += block->myAllocator.GetSize();
+            typeStatistics.myUsedBytes += block->myAllocator.GetUsedSize();
+            typeStatistics.myLargestFreeRange = std::max(typeStatistics.myLargestFreeRange, block->myAllocator.GetLargestFreeRange());
+        }
+    }
+
+    return statistics;
+}
+
+void DeviceMemoryAllocator::PrintStatistics(std::ostream& aStream) const
+{
+    const std::vector<MemoryTypeStatistics> statistics = GetStatistics();
+
+    aStream << std::fixed << std::setprecision(2);
+    for (uint32_t i = 0; i < statistics.size(); i++)
+    {
+        const MemoryTypeStatistics& typeStatistics = statistics[i];
+        if (typeStatistics.myBlockCount == 0)
+            continue;
+
+        aStream << "Memory type " << i << " (heap " << myVkMemoryProperties.memoryTypes[i].heapIndex << "): "
+            << typeStatistics.myAllocationCount << " allocations in " << typeStatistics.myBlockCount << " blocks"
+            << ", " << DeviceMemoryAllocatorPrivate::ToMegabytes(typeStatistics.myUsedBytes) << " / " << DeviceMemoryAllocatorPrivate::ToMegabytes(typeStatistics.myBlockBytes) << " MiB used"
+            << ", largest free range " << DeviceMemoryAllocatorPrivate::ToMegabytes(typeStatistics.myLargestFreeRange) << " MiB" << std::endl;
+    }
+
+    aStream << std::defaultfloat;
+}
+
+uint32_t DeviceMemoryAllocator::FindMemoryType(uint32_t aTypeFilter, VkMemoryPropertyFlags someProperties) const
+{
+    for (uint32_t i = 0; i < myVkMemoryProperties.memoryTypeCount; i++)
+    {
+        if ((aTypeFilter & (1 << i)) && (myVkMemoryProperties.memoryTypes[i].propertyFlags & someProperties) == someProperties)
+            return i;
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+bool DeviceMemoryAllocator::HasMemoryType(uint32_t aTypeFilter, VkMemoryPropertyFlags someProperties) const
+{
+    for (uint32_t i = 0; i < myVkMemoryProperties.memoryTypeCount; i++)
+    {
+        if ((aTypeFilter & (1 << i)) && (myVkMemoryProperties.memoryTypes[i].propertyFlags & someProperties) == someProperties)
+            return true;
+    }
+
+    return false;
+}
+
+MemoryBlock* DeviceMemoryAllocator::CreateBlock(uint32_t aPoolIndex, uint32_t aMemoryTypeIndex, VkDeviceSize aSize, bool anIsDedicated)
+{
+    if (myDeviceAllocationCount >= myMaxAllocationCount)
+        throw std::runtime_error("reached maxMemoryAllocationCount!");
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = aSize;
+    allocInfo.memoryTypeIndex = aMemoryTypeIndex;
+
+    VkDeviceMemory deviceMemory = nullptr;
+    if (vkAllocateMemory(myVkDevice, &allocInfo, nullptr, &deviceMemory) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate device memory block!");
+
+    std::unique_ptr<MemoryBlock> block = std::make_unique<MemoryBlock>(aSize);
+    block->myVkDeviceMemory = deviceMemory;
+    block->myMemoryTypeIndex = aMemoryTypeIndex;
+    block->myPoolIndex = aPoolIndex;
+    block->myIsDedicated = anIsDedicated;
+
+    if (myVkMemoryProperties.memoryTypes[aMemoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(myVkDevice, deviceMemory, 0, VK_WHOLE_SIZE, 0, &block->myMappedData) != VK_SUCCESS)
+        {
+            vkFreeMemory(myVkDevice, deviceMemory, nullptr);
+            throw std::runtime_error("failed to map device memory block!");
+        }
+    }
+
+    myDeviceAllocationCount++;
+
+    myPools[aPoolIndex].myBlocks.push_back(std::move(block));
+    return myPools[aPoolIndex].myBlocks.back().get();
+}
+
+void DeviceMemoryAllocator::DestroyBlock(MemoryBlock* aBlock)
+{
+    if (aBlock->myMappedData)
+        vkUnmapMemory(myVkDevice, aBlock->myVkDeviceMemory);
+
+    vkFreeMemory(myVkDevice, aBlock->myVkDeviceMemory, nullptr);
+    myDeviceAllocationCount--;
+
+    std::vector<std::unique_ptr<MemoryBlock>>& blocks = myPools[aBlock->myPoolIndex].myBlocks;
+    blocks.erase(std::find_if(blocks.begin(), blocks.end(), [aBlock](const std::unique_ptr<MemoryBlock>& aCandidate) { return aCandidate.get() == aBlock; }));
+}
+
+uint32_t DeviceMemoryAllocator::GetPoolIndex(uint32_t aMemoryTypeIndex, MemoryAllocationKind aKind) const
+{
+    // Only split linear and optimal resources into separate blocks when the device actually has a granularity to honor.
+    const bool isSeparated = myBufferImageGranularity > 1 && aKind == MemoryAllocationKind::Optimal;
+    return aMemoryTypeIndex * DeviceMemoryAllocatorPrivate::ourPoolKindCount + (isSeparated ? 1 : 0);
+}
+
+VkDeviceSize DeviceMemoryAllocator::GetPreferredBlockSize(uint32_t aMemoryTypeIndex) const
+{
+    const VkDeviceSize heapSize = myVkMemoryProperties.memoryHeaps[myVkMemoryProperties.memoryTypes[aMemoryTypeIndex].heapIndex].size;
+    if (heapSize <= DeviceMemoryAllocatorPrivate::ourSmallHeapSize)
+        return heapSize / 8;
+
+    return DeviceMemoryAllocatorPrivate::ourLargeHeapBlockSize;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "TlsfAllocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+struct MemoryBlock;
+
+// Buffers and linear images must not share a bufferImageGranularity page with optimal images.
+enum class MemoryAllocationKind
+{
+    Linear,
+    Optimal
+};
+
+struct MemoryAllocation
+{
+    VkDeviceMemory myVkDeviceMemory = nullptr;
+    VkDeviceSize myOffset = 0;
+    VkDeviceSize mySize = 0;
+    void* myMappedData = nullptr;
+
+private:
+    friend class DeviceMemoryAllocator;
+    MemoryBlock* myBlock = nullptr;
+    uint32_t myHandle = TlsfAllocator::ourInvalidHandle;
+};
+
+struct MemoryTypeStatistics
+{
+    uint32_t myBlockCount = 0;
+    uint32_t myAllocationCount = 0;
+    VkDeviceSize myBlockBytes = 0;
+    VkDeviceSize myUsedBytes = 0;
+    VkDeviceSize myLargestFreeRange = 0;
+};
+
+// Grabs large VkDeviceMemory blocks per memory type and sub-allocates them with a TLSF allocator, keeping the
+// vkAllocateMemory count far below maxMemoryAllocationCount. Requests larger than half a block get a dedicated
+// block of their own. Host-visible blocks are persistently mapped. Thread-safe.
+class DeviceMemoryAllocator
+{
+public:
+    DeviceMemoryAllocator();
+    ~DeviceMemoryAllocator();
+
+    void Create(VkDevice aDevice, VkPhysicalDevice aPhysicalDevice);
+    void Destroy();
+
+    MemoryAllocation Allocate(const VkMemoryRequirements& someRequirements, VkMemoryPropertyFlags someProperties, MemoryAllocationKind aKind);
+    MemoryAllocation AllocateForBuffer(VkBuffer aBuffer, VkMemoryPropertyFlags someProperties);
+    MemoryAllocation AllocateForImage(VkImage anImage, VkMemoryPropertyFlags someProperties);
+    void Free(MemoryAllocation& anAllocation);
+
+    std::vector<MemoryTypeStatistics> GetStatistics() const;
+    void PrintStatistics(std::ostream& aStream) const;
+
+    uint32_t FindMemoryType(uint32_t aTypeFilter, VkMemoryPropertyFlags someProperties) const;
+    bool HasMemoryType(uint32_t aTypeFilter, VkMemoryPropertyFlags someProperties) const;
+    VkDevice GetVkDevice() const { return myVkDevice; }
+
+private:
+    struct Pool
+    {
+        std::vector<std::unique_ptr<MemoryBlock>> myBlocks;
+    };
+
+    MemoryBlock* CreateBlock(uint32_t aPoolIndex, uint32_t aMemoryTypeIndex, VkDeviceSize aSize, bool anIsDedicated);
+    void DestroyBlock(MemoryBlock* aBlock);
+    uint32_t GetPoolIndex(uint32_t aMemoryTypeIndex, MemoryAllocationKind aKind) const;
+    VkDeviceSize GetPreferredBlockSize(uint32_t aMemoryTypeIndex) const;
+
+    VkDevice myVkDevice;
+    VkPhysicalDeviceMemoryProperties myVkMemoryProperties;
+    VkDeviceSize myBufferImageGranularity;
+    uint32_t myMaxAllocationCount;
+    uint32_t myDeviceAllocationCount;
+    std::vector<Pool> myPools;
+    mutable std::mutex myMutex;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Laid out like VkDrawIndexedIndirectCommand.
+struct DrawCommand
+{
+    uint32_t myIndexCount;
+    uint32_t myInstanceCount;
+    uint32_t myFirstIndex;
+    int32_t myVertexOffset;
+    uint32_t myFirstInstance;
+};
@@ -0,0 +1,88 @@
+#include "FileWatcher.h"
+#include "CpuTracer.h"
+
+#include <chrono>
+
+namespace FileWatcherPrivate
+{
+    static constexpr std::chrono::milliseconds ourPollInterval(250);
+
+    // Editors that save by replacing the file briefly leave nothing behind, which reads as an unchanged time.
+    static std::filesystem::file_time_type GetWriteTime(const std::string& aPath)
+    {
+        std::error_code error;
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(aPath, error);
+        return error ? std::filesystem::file_time_type::min() : writeTime;
+    }
+}
+
+FileWatcher::FileWatcher()
+    : myIsStopping(false)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    Stop();
+}
+
+void FileWatcher::Start(const std::vector<std::string>& somePaths, const std::function<void(const std::vector<std::string>&)>& aCallback)
+{
+    Stop();
+
+    myPaths = somePaths;
+    myCallback = aCallback;
+    myIsStopping = false;
+
+    myWriteTimes.clear();
+    for (const std::string& path : myPaths)
+        myWriteTimes.push_back(FileWatcherPrivate::GetWriteTime(path));
+
+    myThread = std::thread([this]()
+    {
+        CpuTracer::SetThreadName("File watcher");
+
+        WatchLoop();
+    });
+}
+
+void FileWatcher::Stop()
+{
+    if (!myThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myIsStopping = true;
+    }
+
+    myStopRequested.notify_all();
+    myThread.join();
+}
+
+void FileWatcher::WatchLoop()
+{
+    std::unique_lock<std::mutex> lock(myMutex);
+
+    while (!myStopRequested.wait_for(lock, FileWatcherPrivate::ourPollInterval, [this]() { return myIsStopping; }))
+    {
+        std::vector<std::string> changedPaths;
+        for (size_t i = 0; i < myPaths.size(); i++)
+        {
+            const std::filesystem::file_time_type writeTime = FileWatcherPrivate::GetWriteTime(myPaths[i]);
+            if (writeTime == std::filesystem::file_time_type::min() || writeTime == myWriteTimes[i])
+                continue;
+
+            myWriteTimes[i] = writeTime;
+            changedPaths.push_back(myPaths[i]);
+        }
+
+        if (changedPaths.empty())
+            continue;
+
+        // Stop only waits for the callback to return, it does not interrupt it.
+        lock.unlock();
+        myCallback(changedPaths);
+        lock.lock();
+    }
+}
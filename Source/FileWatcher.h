@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Polls the modification times of a fixed set of files on a background thread, and calls back on that thread with
+// the files that changed since the previous poll.
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    void Start(const std::vector<std::string>& somePaths, const std::function<void(const std::vector<std::string>&)>& aCallback);
+    void Stop();
+
+private:
+    void WatchLoop();
+
+    std::vector<std::string> myPaths;
+    std::vector<std::filesystem::file_time_type> myWriteTimes;
+    std::function<void(const std::vector<std::string>&)> myCallback;
+    std::thread myThread;
+    std::mutex myMutex;
+    std::condition_variable myStopRequested;
+    bool myIsStopping;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+// Command pools are externally synchronized, so every recording thread gets its own pool per frame in flight.
+// The primary command buffer lives in the first pool and is recorded before the secondaries are handed out.
+struct FrameCommandBuffers
+{
+    std::vector<VkCommandPool> myVkCommandPools;
+    std::vector<VkCommandBuffer> myVkSecondaryCommandBuffers;
+    VkCommandBuffer myVkPrimaryCommandBuffer = nullptr;
+};
@@ -0,0 +1,87 @@
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+FrameStatistics::FrameStatistics()
+    : myElapsedTimeMs(0.0)
+{
+}
+
+void FrameStatistics::Reset()
+{
+    myFrameTimes.clear();
+    myElapsedTimeMs = 0.0;
+}
+
+void FrameStatistics::AddFrameTime(double aFrameTimeMs)
+{
+    myFrameTimes.push_back(aFrameTimeMs);
+}
+
+void FrameStatistics::SetElapsedTime(double anElapsedTimeMs)
+{
+    myElapsedTimeMs = anElapsedTimeMs;
+}
+
+double FrameStatistics::GetMinimum() const
+{
+    if (myFrameTimes.empty())
+        return 0.0;
+
+    return *std::min_element(myFrameTimes.begin(), myFrameTimes.end());
+}
+
+double FrameStatistics::GetMaximum() const
+{
+    if (myFrameTimes.empty())
+        return 0.0;
+
+    return *std::max_element(myFrameTimes.begin(), myFrameTimes.end());
+}
+
+double FrameStatistics::GetAverage() const
+{
+    if (myFrameTimes.empty())
+        return 0.0;
+
+    return std::accumulate(myFrameTimes.begin(), myFrameTimes.end(), 0.0) / static_cast<double>(myFrameTimes.size());
+}
+
+double FrameStatistics::GetPercentile(double aPercentile) const
+{
+    if (myFrameTimes.empty())
+        return 0.0;
+
+    std::vector<double> sortedFrameTimes = myFrameTimes;
+    std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+
+    const double rank = std::ceil(aPercentile / 100.0 * static_cast<double>(sortedFrameTimes.size()));
+    const size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    return sortedFrameTimes[std::min(index, sortedFrameTimes.size() - 1)];
+}
+
+double FrameStatistics::GetFramesPerSecond() const
+{
+    if (myElapsedTimeMs <= 0.0)
+        return 0.0;
+
+    return static_cast<double>(myFrameTimes.size()) * 1000.0 / myElapsedTimeMs;
+}
+
+void FrameStatistics::Print(std::ostream& aStream, const std::string& aLabel) const
+{
+    aStream << std::fixed << std::setprecision(3)
+        << aLabel << ": " << myFrameTimes.size() << " frames"
+        << ", min " << GetMinimum() << " ms"
+        << ", avg " << GetAverage() << " ms"
+        << ", p99 " << GetPercentile(99.0) << " ms"
+        << ", max " << GetMaximum() << " ms";
+
+    if (myElapsedTimeMs > 0.0)
+        aStream << ", " << std::setprecision(1) << GetFramesPerSecond() << " frames/s";
+
+    aStream << std::defaultfloat << std::endl;
+}
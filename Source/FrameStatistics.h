@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class FrameStatistics
+{
+public:
+    FrameStatistics();
+
+    void Reset();
+    void AddFrameTime(double aFrameTimeMs);
+    void SetElapsedTime(double anElapsedTimeMs);
+
+    size_t GetFrameCount() const { return myFrameTimes.size(); }
+    double GetMinimum() const;
+    double GetMaximum() const;
+    double GetAverage() const;
+    double GetPercentile(double aPercentile) const;
+    double GetFramesPerSecond() const;
+
+    void Print(std::ostream& aStream, const std::string& aLabel) const;
+
+private:
+    std::vector<double> myFrameTimes;
+    double myElapsedTimeMs;
+};
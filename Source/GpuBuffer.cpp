@@ -0,0 +1,56 @@
+#include "GpuBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GpuBuffer::GpuBuffer()
+    : myAllocator(nullptr)
+    , myVkBuffer(nullptr)
+    , mySize(0)
+{
+}
+
+void GpuBuffer::Create(DeviceMemoryAllocator& anAllocator, VkDeviceSize aSize, VkBufferUsageFlags someUsages, VkMemoryPropertyFlags someProperties, const std::vector<uint32_t>& someQueueFamilyIndices)
+{
+    myAllocator = &anAllocator;
+    mySize = aSize;
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = aSize;
+    bufferInfo.usage = someUsages;
+
+    std::vector<uint32_t> queueFamilyIndices = someQueueFamilyIndices;
+    std::sort(queueFamilyIndices.begin(), queueFamilyIndices.end());
+    queueFamilyIndices.erase(std::unique(queueFamilyIndices.begin(), queueFamilyIndices.end()), queueFamilyIndices.end());
+
+    if (queueFamilyIndices.size() > 1)
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndices.size());
+        bufferInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+    }
+    else
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    if (vkCreateBuffer(myAllocator->GetVkDevice(), &bufferInfo, nullptr, &myVkBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to create buffer!");
+
+    myAllocation = myAllocator->AllocateForBuffer(myVkBuffer, someProperties);
+}
+
+void GpuBuffer::Destroy()
+{
+    if (!myAllocator)
+        return;
+
+    if (myVkBuffer)
+        vkDestroyBuffer(myAllocator->GetVkDevice(), myVkBuffer, nullptr);
+
+    myAllocator->Free(myAllocation);
+
+    myVkBuffer = nullptr;
+    mySize = 0;
+}
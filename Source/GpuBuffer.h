@@ -0,0 +1,29 @@
+#pragma once
+
+#include "DeviceMemoryAllocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+class GpuBuffer
+{
+public:
+    GpuBuffer();
+
+    // Host-visible buffers are placed in persistently mapped blocks and stay mapped until Destroy.
+    // Passing more than one distinct queue family shares the buffer concurrently between them, with no ownership transfers.
+    void Create(DeviceMemoryAllocator& anAllocator, VkDeviceSize aSize, VkBufferUsageFlags someUsages, VkMemoryPropertyFlags someProperties, const std::vector<uint32_t>& someQueueFamilyIndices = {});
+    void Destroy();
+
+    VkBuffer GetVkBuffer() const { return myVkBuffer; }
+    VkDeviceSize GetSize() const { return mySize; }
+    void* GetMappedData() const { return myAllocation.myMappedData; }
+
+private:
+    DeviceMemoryAllocator* myAllocator;
+    MemoryAllocation myAllocation;
+    VkBuffer myVkBuffer;
+    VkDeviceSize mySize;
+};
@@ -0,0 +1,281 @@
+#include "GpuCuller.h"
+#include "AssetArchive.h"
+#include "DrawCommand.h"
+#include "PipelineCache.h"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace GpuCullerPrivate
+{
+    static constexpr uint32_t ourWorkgroupSize = 64;
+    static constexpr uint32_t ourBindingCount = 4;
+
+    // Matches the push constant block of cull.comp.
+    struct CullingConstants
+    {
+        glm::vec4 myFrustumPlanes[6];
+        uint32_t myObjectCount;
+        float myBoundingRadius;
+    };
+
+    static glm::vec4 GetRow(const glm::mat4& aMatrix, int aRow)
+    {
+        return glm::vec4(aMatrix[0][aRow], aMatrix[1][aRow], aMatrix[2][aRow], aMatrix[3][aRow]);
+    }
+
+    static glm::vec4 NormalizePlane(const glm::vec4& aPlane)
+    {
+        return aPlane / glm::length(glm::vec3(aPlane));
+    }
+
+    // Planes point inwards and are extracted straight from the view-projection matrix, with Vulkan's [0, 1] clip depth.
+    static void ExtractFrustumPlanes(const glm::mat4& aViewProjection, glm::vec4 someOutPlanes[6])
+    {
+        const glm::vec4 row0 = GetRow(aViewProjection, 0);
+        const glm::vec4 row1 = GetRow(aViewProjection, 1);
+        const glm::vec4 row2 = GetRow(aViewProjection, 2);
+        const glm::vec4 row3 = GetRow(aViewProjection, 3);
+
+        someOutPlanes[0] = NormalizePlane(row3 + row0);
+        someOutPlanes[1] = NormalizePlane(row3 - row0);
+        someOutPlanes[2] = NormalizePlane(row3 + row1);
+        someOutPlanes[3] = NormalizePlane(row3 - row1);
+        someOutPlanes[4] = NormalizePlane(row2);
+        someOutPlanes[5] = NormalizePlane(row3 - row2);
+    }
+}
+
+GpuCuller::GpuCuller()
+    : myVkDevice(nullptr)
+    , myVkDescriptorSetLayout(nullptr)
+    , myVkDescriptorPool(nullptr)
+    , myVkPipelineLayout(nullptr)
+    , myVkPipeline(nullptr)
+    , myObjectCount(0)
+    , myBoundingRadius(0.0f)
+{
+}
+
+void GpuCuller::Create(VkDevice aDevice, PipelineCache& aPipelineCache, const AssetView& aShaderCode, uint32_t aFrameCount)
+{
+    myVkDevice = aDevice;
+
+    // Instances and source commands are read, culled commands and the draw count are written.
+    VkDescriptorSetLayoutBinding bindings[GpuCullerPrivate::ourBindingCount] = {};
+    for (uint32_t i = 0; i < GpuCullerPrivate::ourBindingCount; i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = GpuCullerPrivate::ourBindingCount;
+    layoutInfo.pBindings = bindings;
+
+    if (vkCreateDescriptorSetLayout(myVkDevice, &layoutInfo, nullptr, &myVkDescriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create culling descriptor set layout!");
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = GpuCullerPrivate::ourBindingCount * aFrameCount;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = aFrameCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(myVkDevice, &poolInfo, nullptr, &myVkDescriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create culling descriptor pool!");
+
+    myFrameBuffers.resize(aFrameCount);
+
+    std::vector<VkDescriptorSetLayout> setLayouts(aFrameCount, myVkDescriptorSetLayout);
+    std::vector<VkDescriptorSet> descriptorSets(aFrameCount);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = myVkDescriptorPool;
+    allocInfo.descriptorSetCount = aFrameCount;
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(myVkDevice, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate culling descriptor sets!");
+
+    for (uint32_t i = 0; i < aFrameCount; i++)
+        myFrameBuffers[i].myVkDescriptorSet = descriptorSets[i];
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GpuCullerPrivate::CullingConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &myVkDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(myVkDevice, &pipelineLayoutInfo, nullptr, &myVkPipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create culling pipeline layout!");
+
+    myVkPipeline = CreatePipeline(aPipelineCache, aShaderCode);
+}
+
+VkPipeline GpuCuller::CreatePipeline(PipelineCache& aPipelineCache, const AssetView& aShaderCode) const
+{
+    VkShaderModuleCreateInfo shaderModuleInfo = {};
+    shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleInfo.codeSize = aShaderCode.mySize;
+    shaderModuleInfo.pCode = static_cast<const uint32_t*>(aShaderCode.myData);
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(myVkDevice, &shaderModuleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        throw std::runtime_error("failed to create shader module!");
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = myVkPipelineLayout;
+
+    PipelineCreationFeedback feedback;
+    pipelineInfo.pNext = aPipelineCache.ChainCreationFeedback(feedback, pipelineInfo.pNext);
+
+    const std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline = nullptr;
+    const VkResult result = vkCreateComputePipelines(myVkDevice, aPipelineCache.GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(myVkDevice, shaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create culling pipeline!");
+
+    aPipelineCache.RecordCreationTime("Culling", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - creationStart).count(), feedback);
+
+    return pipeline;
+}
+
+VkPipeline GpuCuller::ReplacePipeline(VkPipeline aPipeline)
+{
+    VkPipeline previousPipeline = myVkPipeline;
+    myVkPipeline = aPipeline;
+    return previousPipeline;
+}
+
+void GpuCuller::Destroy()
+{
+    DestroyScene();
+    myFrameBuffers.clear();
+
+    if (myVkPipeline)
+        vkDestroyPipeline(myVkDevice, myVkPipeline, nullptr);
+
+    if (myVkPipelineLayout)
+        vkDestroyPipelineLayout(myVkDevice, myVkPipelineLayout, nullptr);
+
+    if (myVkDescriptorPool)
+        vkDestroyDescriptorPool(myVkDevice, myVkDescriptorPool, nullptr);
+
+    if (myVkDescriptorSetLayout)
+        vkDestroyDescriptorSetLayout(myVkDevice, myVkDescriptorSetLayout, nullptr);
+
+    myVkPipeline = nullptr;
+    myVkPipelineLayout = nullptr;
+    myVkDescriptorPool = nullptr;
+    myVkDescriptorSetLayout = nullptr;
+}
+
+void GpuCuller::SetScene(DeviceMemoryAllocator& anAllocator, const std::vector<VkBuffer>& someInstanceBuffers, const GpuBuffer& aDrawCommandBuffer, uint32_t anObjectCount, float aBoundingRadius)
+{
+    DestroyScene();
+
+    myObjectCount = anObjectCount;
+    myBoundingRadius = aBoundingRadius;
+
+    // Every object may survive, so each frame's output is sized for all of them.
+    const VkDeviceSize drawCommandBufferSize = sizeof(DrawCommand) * static_cast<VkDeviceSize>(anObjectCount);
+
+    for (size_t frameIndex = 0; frameIndex < myFrameBuffers.size(); frameIndex++)
+    {
+        FrameBuffers& frameBuffers = myFrameBuffers[frameIndex];
+
+        frameBuffers.myDrawCommandBuffer.Create(anAllocator, drawCommandBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frameBuffers.myDrawCountBuffer.Create(anAllocator, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        const VkDescriptorBufferInfo bufferInfos[GpuCullerPrivate::ourBindingCount] =
+        {
+            { someInstanceBuffers[frameIndex % someInstanceBuffers.size()], 0, VK_WHOLE_SIZE },
+            { aDrawCommandBuffer.GetVkBuffer(), 0, VK_WHOLE_SIZE },
+            { frameBuffers.myDrawCommandBuffer.GetVkBuffer(), 0, VK_WHOLE_SIZE },
+            { frameBuffers.myDrawCountBuffer.GetVkBuffer(), 0, VK_WHOLE_SIZE }
+        };
+
+        VkWriteDescriptorSet descriptorWrites[GpuCullerPrivate::ourBindingCount] = {};
+        for (uint32_t i = 0; i < GpuCullerPrivate::ourBindingCount; i++)
+        {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = frameBuffers.myVkDescriptorSet;
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(myVkDevice, GpuCullerPrivate::ourBindingCount, descriptorWrites, 0, nullptr);
+    }
+}
+
+void GpuCuller::DestroyScene()
+{
+    for (FrameBuffers& frameBuffers : myFrameBuffers)
+    {
+        frameBuffers.myDrawCountBuffer.Destroy();
+        frameBuffers.myDrawCommandBuffer.Destroy();
+    }
+
+    myObjectCount = 0;
+}
+
+void GpuCuller::RecordCulling(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex, const glm::mat4& aViewProjection)
+{
+    const FrameBuffers& frameBuffers = myFrameBuffers[aFrameIndex];
+
+    vkCmdFillBuffer(aCommandBuffer, frameBuffers.myDrawCountBuffer.GetVkBuffer(), 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier = {};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    GpuCullerPrivate::CullingConstants constants = {};
+    GpuCullerPrivate::ExtractFrustumPlanes(aViewProjection, constants.myFrustumPlanes);
+    constants.myObjectCount = myObjectCount;
+    constants.myBoundingRadius = myBoundingRadius;
+
+    vkCmdBindPipeline(aCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, myVkPipeline);
+    vkCmdBindDescriptorSets(aCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, myVkPipelineLayout, 0, 1, &frameBuffers.myVkDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(aCommandBuffer, myVkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(aCommandBuffer, (myObjectCount + GpuCullerPrivate::ourWorkgroupSize - 1) / GpuCullerPrivate::ourWorkgroupSize, 1, 1);
+
+    VkMemoryBarrier cullBarrier = {};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuCuller::RecordDraw(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex) const
+{
+    const FrameBuffers& frameBuffers = myFrameBuffers[aFrameIndex];
+
+    vkCmdDrawIndexedIndirectCount(aCommandBuffer, frameBuffers.myDrawCommandBuffer.GetVkBuffer(), 0, frameBuffers.myDrawCountBuffer.GetVkBuffer(), 0, myObjectCount, sizeof(DrawCommand));
+}
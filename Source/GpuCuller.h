@@ -0,0 +1,58 @@
+#pragma once
+
+#include "GpuBuffer.h"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+class PipelineCache;
+struct AssetView;
+
+// Frustum-culls per-object draw commands on the GPU and compacts the survivors into an indirect buffer, so the CPU
+// records the same handful of commands whatever the object count.
+// Each frame in flight has its own output and count buffers, so culling a frame never races the draws of another.
+class GpuCuller
+{
+public:
+    GpuCuller();
+
+    void Create(VkDevice aDevice, PipelineCache& aPipelineCache, const AssetView& aShaderCode, uint32_t aFrameCount);
+    void Destroy();
+
+    // Builds a pipeline for new shader code against the existing layout, e.g. for a shader reload. Thread-safe.
+    VkPipeline CreatePipeline(PipelineCache& aPipelineCache, const AssetView& aShaderCode) const;
+    // Returns the previous pipeline, which the caller destroys once the frames recorded with it have completed.
+    VkPipeline ReplacePipeline(VkPipeline aPipeline);
+
+    // Objects are the draw commands in aDrawCommandBuffer; each one is bounded by a sphere around its instance offset
+    // with radius aBoundingRadius times its instance scale. Frame i reads its instances from
+    // someInstanceBuffers[i % size], so animated scenes can pass one buffer per frame. All buffers need storage buffer usage.
+    void SetScene(DeviceMemoryAllocator& anAllocator, const std::vector<VkBuffer>& someInstanceBuffers, const GpuBuffer& aDrawCommandBuffer, uint32_t anObjectCount, float aBoundingRadius);
+    void DestroyScene();
+
+    // Must be recorded outside a render pass, after the frame slot's previous submission has completed.
+    void RecordCulling(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex, const glm::mat4& aViewProjection);
+    void RecordDraw(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex) const;
+
+    bool IsEnabled() const { return myVkPipeline != nullptr; }
+
+private:
+    struct FrameBuffers
+    {
+        GpuBuffer myDrawCommandBuffer;
+        GpuBuffer myDrawCountBuffer;
+        VkDescriptorSet myVkDescriptorSet = nullptr;
+    };
+
+    VkDevice myVkDevice;
+    VkDescriptorSetLayout myVkDescriptorSetLayout;
+    VkDescriptorPool myVkDescriptorPool;
+    VkPipelineLayout myVkPipelineLayout;
+    VkPipeline myVkPipeline;
+    std::vector<FrameBuffers> myFrameBuffers;
+    uint32_t myObjectCount;
+    float myBoundingRadius;
+};
@@ -0,0 +1,244 @@
+#include "GpuProfiler.h"
+#include "FrameStatistics.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace GpuProfilerPrivate
+{
+    static constexpr uint32_t ourMaxScopesPerFrame = 32;
+    static constexpr uint32_t ourQueriesPerFrame = ourMaxScopesPerFrame * 2;
+    static constexpr size_t ourRollingWindowSize = 512;
+
+    static FrameStatistics GetStatistics(const std::deque<double>& someSamples)
+    {
+        FrameStatistics statistics;
+        for (double sample : someSamples)
+            statistics.AddFrameTime(sample);
+
+        return statistics;
+    }
+}
+
+GpuProfiler::GpuProfiler()
+    : myVkDevice(nullptr)
+    , myVkQueryPool(nullptr)
+    , myTimestampMask(0)
+    , myTimestampPeriodNs(0.0)
+    , myCurrentFrameIndex(0)
+{
+}
+
+void GpuProfiler::Create(VkDevice aDevice, const VkPhysicalDeviceProperties& someProperties, uint32_t aTimestampValidBits, uint32_t aFrameCount)
+{
+    myVkDevice = aDevice;
+
+    if (aTimestampValidBits == 0 || someProperties.limits.timestampPeriod <= 0.0f)
+    {
+        std::cout << "GPU timestamps are not supported by the graphics queue, GPU profiling is disabled" << std::endl;
+        return;
+    }
+
+    myTimestampMask = aTimestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << aTimestampValidBits) - 1;
+    myTimestampPeriodNs = someProperties.limits.timestampPeriod;
+    myFrameQueries.resize(aFrameCount);
+
+    VkQueryPoolCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    createInfo.queryCount = GpuProfilerPrivate::ourQueriesPerFrame * aFrameCount;
+
+    if (vkCreateQueryPool(myVkDevice, &createInfo, nullptr, &myVkQueryPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create timestamp query pool!");
+}
+
+void GpuProfiler::Destroy()
+{
+    if (myVkQueryPool)
+        vkDestroyQueryPool(myVkDevice, myVkQueryPool, nullptr);
+
+    myVkQueryPool = nullptr;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex)
+{
+    if (!IsEnabled())
+        return;
+
+    myCurrentFrameIndex = aFrameIndex;
+
+    CollectFrame(aFrameIndex);
+
+    const uint32_t firstQuery = aFrameIndex * GpuProfilerPrivate::ourQueriesPerFrame;
+    vkCmdResetQueryPool(aCommandBuffer, myVkQueryPool, firstQuery, GpuProfilerPrivate::ourQueriesPerFrame);
+}
+
+uint32_t GpuProfiler::BeginScope(VkCommandBuffer aCommandBuffer, const std::string& aName, VkPipelineStageFlagBits aStage)
+{
+    if (!IsEnabled())
+        return UINT32_MAX;
+
+    FrameQueries& frameQueries = myFrameQueries[myCurrentFrameIndex];
+    if (frameQueries.myScopeNames.size() >= GpuProfilerPrivate::ourMaxScopesPerFrame)
+        return UINT32_MAX;
+
+    const uint32_t scopeIndex = static_cast<uint32_t>(frameQueries.myScopeNames.size());
+    frameQueries.myScopeNames.push_back(aName);
+    frameQueries.myQueryCount = (scopeIndex + 1) * 2;
+
+    vkCmdWriteTimestamp(aCommandBuffer, aStage, myVkQueryPool, myCurrentFrameIndex * GpuProfilerPrivate::ourQueriesPerFrame + scopeIndex * 2);
+    return scopeIndex;
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer aCommandBuffer, uint32_t aScopeIndex, VkPipelineStageFlagBits aStage)
+{
+    if (!IsEnabled() || aScopeIndex == UINT32_MAX)
+        return;
+
+    vkCmdWriteTimestamp(aCommandBuffer, aStage, myVkQueryPool, myCurrentFrameIndex * GpuProfilerPrivate::ourQueriesPerFrame + aScopeIndex * 2 + 1);
+}
+
+void GpuProfiler::CollectPending()
+{
+    if (!IsEnabled())
+        return;
+
+    for (uint32_t i = 0; i < myFrameQueries.size(); i++)
+        CollectFrame(i);
+}
+
+double GpuProfiler::GetAverage(const std::string& aName) const
+{
+    const ScopeSamples* scope = FindScope(aName);
+    if (!scope)
+        return 0.0;
+
+    return GpuProfilerPrivate::GetStatistics(scope->mySamples).GetAverage();
+}
+
+void GpuProfiler::ResetStatistics()
+{
+    myScopes.clear();
+
+    for (FrameQueries& frameQueries : myFrameQueries)
+    {
+        frameQueries.myScopeNames.clear();
+        frameQueries.myQueryCount = 0;
+    }
+}
+
+void GpuProfiler::WriteJson(const std::string& aPath) const
+{
+    std::ofstream file(aPath, std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open GPU profile output " + aPath);
+
+    file << std::fixed << std::setprecision(6);
+    file << "{\n  \"timestampPeriodNs\": " << myTimestampPeriodNs << ",\n  \"scopes\": [";
+
+    for (size_t i = 0; i < myScopes.size(); i++)
+    {
+        const ScopeSamples& scope = myScopes[i];
+        const FrameStatistics statistics = GpuProfilerPrivate::GetStatistics(scope.mySamples);
+
+        file << (i == 0 ? "\n" : ",\n")
+            << "    { \"name\": \"" << scope.myName << "\""
+            << ", \"totalSamples\": " << scope.myTotalSampleCount
+            << ", \"windowSamples\": " << statistics.GetFrameCount()
+            << ", \"minMs\": " << statistics.GetMinimum()
+            << ", \"avgMs\": " << statistics.GetAverage()
+            << ", \"p99Ms\": " << statistics.GetPercentile(99.0)
+            << ", \"maxMs\": " << statistics.GetMaximum() << " }";
+    }
+
+    file << "\n  ]\n}\n";
+}
+
+void GpuProfiler::WriteCsv(const std::string& aPath) const
+{
+    std::ofstream file(aPath, std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open GPU profile output " + aPath);
+
+    file << std::fixed << std::setprecision(6);
+    file << "scope,total_samples,window_samples,min_ms,avg_ms,p99_ms,max_ms\n";
+
+    for (const ScopeSamples& scope : myScopes)
+    {
+        const FrameStatistics statistics = GpuProfilerPrivate::GetStatistics(scope.mySamples);
+
+        file << scope.myName << ","
+            << scope.myTotalSampleCount << ","
+            << statistics.GetFrameCount() << ","
+            << statistics.GetMinimum() << ","
+            << statistics.GetAverage() << ","
+            << statistics.GetPercentile(99.0) << ","
+            << statistics.GetMaximum() << "\n";
+    }
+}
+
+void GpuProfiler::Print() const
+{
+    for (const ScopeSamples& scope : myScopes)
+        GpuProfilerPrivate::GetStatistics(scope.mySamples).Print(std::cout, "GPU " + scope.myName);
+}
+
+void GpuProfiler::CollectFrame(uint32_t aFrameIndex)
+{
+    FrameQueries& frameQueries = myFrameQueries[aFrameIndex];
+    const uint32_t firstQuery = aFrameIndex * GpuProfilerPrivate::ourQueriesPerFrame;
+
+    if (frameQueries.myQueryCount > 0)
+    {
+        std::vector<uint64_t> timestamps(frameQueries.myQueryCount);
+        VkResult result = vkGetQueryPoolResults(myVkDevice, myVkQueryPool, firstQuery, frameQueries.myQueryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        if (result == VK_SUCCESS)
+        {
+            for (uint32_t i = 0; i < frameQueries.myScopeNames.size(); i++)
+            {
+                const uint64_t ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & myTimestampMask;
+                AddSample(frameQueries.myScopeNames[i], static_cast<double>(ticks) * myTimestampPeriodNs / 1000000.0);
+            }
+        }
+    }
+
+    frameQueries.myScopeNames.clear();
+    frameQueries.myQueryCount = 0;
+}
+
+void GpuProfiler::AddSample(const std::string& aName, double aTimeMs)
+{
+    ScopeSamples* scope = nullptr;
+    for (ScopeSamples& existingScope : myScopes)
+    {
+        if (existingScope.myName == aName)
+            scope = &existingScope;
+    }
+
+    if (!scope)
+    {
+        myScopes.push_back({});
+        scope = &myScopes.back();
+        scope->myName = aName;
+    }
+
+    scope->mySamples.push_back(aTimeMs);
+    scope->myTotalSampleCount++;
+
+    if (scope->mySamples.size() > GpuProfilerPrivate::ourRollingWindowSize)
+        scope->mySamples.pop_front();
+}
+
+const GpuProfiler::ScopeSamples* GpuProfiler::FindScope(const std::string& aName) const
+{
+    for (const ScopeSamples& scope : myScopes)
+    {
+        if (scope.myName == aName)
+            return &scope;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+class GpuProfiler
+{
+public:
+    GpuProfiler();
+
+    void Create(VkDevice aDevice, const VkPhysicalDeviceProperties& someProperties, uint32_t aTimestampValidBits, uint32_t aFrameCount);
+    void Destroy();
+
+    // Collects the timestamps written the last time this frame slot was recorded and resets its queries.
+    // Must be called after the frame slot's previous submission has completed, so reading back never stalls.
+    void BeginFrame(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex);
+
+    uint32_t BeginScope(VkCommandBuffer aCommandBuffer, const std::string& aName, VkPipelineStageFlagBits aStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    void EndScope(VkCommandBuffer aCommandBuffer, uint32_t aScopeIndex, VkPipelineStageFlagBits aStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    // Collects the timestamps of every frame slot. Only valid once the device is idle.
+    void CollectPending();
+
+    double GetAverage(const std::string& aName) const;
+
+    // Drops the collected samples and the frames not read back yet, e.g. after warmup or between benchmark
+    // configurations.
+    void ResetStatistics();
+
+    void WriteJson(const std::string& aPath) const;
+    void WriteCsv(const std::string& aPath) const;
+    void Print() const;
+
+    bool IsEnabled() const { return myVkQueryPool != nullptr; }
+
+private:
+    struct FrameQueries
+    {
+        std::vector<std::string> myScopeNames;
+        uint32_t myQueryCount = 0;
+    };
+
+    struct ScopeSamples
+    {
+        std::string myName;
+        std::deque<double> mySamples;
+        uint64_t myTotalSampleCount = 0;
+    };
+
+    void CollectFrame(uint32_t aFrameIndex);
+    void AddSample(const std::string& aName, double aTimeMs);
+    const ScopeSamples* FindScope(const std::string& aName) const;
+
+    VkDevice myVkDevice;
+    VkQueryPool myVkQueryPool;
+    std::vector<FrameQueries> myFrameQueries;
+    std::vector<ScopeSamples> myScopes;
+    uint64_t myTimestampMask;
+    double myTimestampPeriodNs;
+    uint32_t myCurrentFrameIndex;
+};
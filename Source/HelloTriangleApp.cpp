@@ -1,9 +1,21 @@
 #include "HelloTriangleApp.h"
+#include "CpuTracer.h"
+#include "FrameStatistics.h"
 #include "QueueFamilyIndices.h"
 #include "SwapChainSupportDetails.h"
+#include "Vertex.h"
 
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <cmath>
+#include <iomanip>
+#include <iterator>
 #include <iostream>
 #include <set>
 #include <stdexcept>
@@ -16,11 +28,101 @@ const bool enableValidationLayers = true;
 
 namespace HelloTriangleAppPrivate
 {
-    static constexpr char* ourAppName = "HelloTriangle";
-    static constexpr char* ourEngineName = "HelloVulkan";
+    static constexpr const char* ourAppName = "HelloTriangle";
+    static constexpr const char* ourEngineName = "HelloVulkan";
     static constexpr int ourWidth = 800;
     static constexpr int ourHeight = 600;
-    static constexpr int ourMaxFramesInFlight = 2;
+    static constexpr uint32_t ourOffscreenImageCount = 3;
+    static constexpr VkFormat ourOffscreenImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    static constexpr uint32_t ourMinDrawsPerRecordingThread = 64;
+    static constexpr VkDeviceSize ourStagingRingCapacity = 4 * 1024 * 1024;
+    static constexpr VkDeviceSize ourFrameUniformCapacity = 64 * 1024;
+    static constexpr VkDeviceSize ourTextureUploadBudget = 4 * 1024 * 1024;
+    static constexpr uint32_t ourCheckerboardSize = 256;
+    static constexpr uint32_t ourCheckerboardSquareSize = 32;
+
+    static const std::vector<Vertex> ourTriangleVertices =
+    {
+        { { 0.0f, -0.5f }, { 1.0f, 0.0f, 0.0f } },
+        { { 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f } },
+        { { -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f } }
+    };
+
+    static const std::vector<uint16_t> ourTriangleIndices =
+    {
+        0, 1, 2
+    };
+
+    // Tints applied per object, read by the fragment shader through the bindless set.
+    static const std::vector<glm::vec4> ourMaterialColors =
+    {
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 0.6f, 0.6f, 1.0f },
+        { 0.6f, 1.0f, 0.6f, 1.0f },
+        { 0.6f, 0.6f, 1.0f, 1.0f },
+        { 1.0f, 1.0f, 0.5f, 1.0f },
+        { 0.5f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 0.5f, 1.0f, 1.0f },
+        { 0.7f, 0.7f, 0.7f, 1.0f }
+    };
+
+    // Matches the FrameUniforms block of shader.vert (set 1, std140).
+    struct FrameUniforms
+    {
+        glm::mat4 myViewProjection;
+    };
+
+    // Matches the push constant block of shader.vert and shader.frag.
+    struct SceneConstants
+    {
+        uint32_t myMaterialBufferHandle;
+        uint32_t myMaterialCount;
+        uint32_t myTextureHandle;
+        uint32_t mySamplerHandle;
+    };
+
+    // Pipelines rebuilt when one of their shader sources changes.
+    static constexpr uint32_t ourScenePipelineBit = 1 << 0;
+    static constexpr uint32_t ourPostProcessPipelineBit = 1 << 1;
+    static constexpr uint32_t ourCullingPipelineBit = 1 << 2;
+    static constexpr uint32_t ourSimulationPipelineBit = 1 << 3;
+
+    struct ShaderSource
+    {
+        const char* myName;
+        uint32_t myPipelines;
+    };
+
+    static const std::vector<ShaderSource> ourShaderSources =
+    {
+        { "shader.vert", ourScenePipelineBit },
+        { "shader.frag", ourScenePipelineBit },
+        { "post.vert", ourPostProcessPipelineBit },
+        { "post.frag", ourPostProcessPipelineBit },
+        { "cull.comp", ourCullingPipelineBit },
+        { "simulate.comp", ourSimulationPipelineBit }
+    };
+
+    // Keeps the pending pipeline when creation throws, e.g. on a compile error, which is printed.
+    template <typename Function>
+    static void RebuildPipeline(VkDevice aDevice, VkPipeline& aPendingPipeline, const Function& aCreatePipeline)
+    {
+        VkPipeline pipeline = nullptr;
+        try
+        {
+            pipeline = aCreatePipeline();
+        }
+        catch (const std::exception& anException)
+        {
+            std::cerr << anException.what() << std::endl;
+            return;
+        }
+
+        if (aPendingPipeline)
+            vkDestroyPipeline(aDevice, aPendingPipeline, nullptr);
+
+        aPendingPipeline = pipeline;
+    }
 
     static const std::vector<const char*> ourValidationLayers =
     {
@@ -32,6 +134,45 @@ namespace HelloTriangleAppPrivate
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
 
+    static const char* GetPresentPolicyName(PresentPolicy aPolicy)
+    {
+        switch (aPolicy)
+        {
+        case PresentPolicy::LowLatency: return "low-latency";
+        case PresentPolicy::Throughput: return "throughput";
+        case PresentPolicy::VSync: return "vsync";
+        case PresentPolicy::PowerSaver: return "power-saver";
+        }
+
+        return "unknown";
+    }
+
+    static const char* GetPresentModeName(VkPresentModeKHR aPresentMode)
+    {
+        switch (aPresentMode)
+        {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+        case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+        default: return "unknown";
+        }
+    }
+
+    // In order of preference. FIFO is always supported and ends every list.
+    static std::vector<VkPresentModeKHR> GetPreferredPresentModes(PresentPolicy aPolicy)
+    {
+        switch (aPolicy)
+        {
+        case PresentPolicy::LowLatency: return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR };
+        case PresentPolicy::Throughput: return { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR };
+        case PresentPolicy::VSync: return { VK_PRESENT_MODE_FIFO_KHR };
+        case PresentPolicy::PowerSaver: return { VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+        }
+
+        return { VK_PRESENT_MODE_FIFO_KHR };
+    }
+
     static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT aMessageSeverity, VkDebugUtilsMessageTypeFlagsEXT aMessageType, const VkDebugUtilsMessengerCallbackDataEXT* aCallbackData, void* anUserData)
     {
         if (aMessageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
@@ -61,31 +202,62 @@ namespace HelloTriangleAppPrivate
     }
 }
 
-HelloTriangleApp::HelloTriangleApp()
-    : myGLFWWindow(nullptr)
+HelloTriangleApp::HelloTriangleApp(const ApplicationSettings& aSettings)
+    : mySettings(aSettings)
+    , myGLFWWindow(nullptr)
     , myVkInstance(nullptr)
     , myVkDebugMessenger(nullptr)
     , myVkSurface(nullptr)
     , myVkPhysicalDevice(nullptr)
     , myVkDevice(nullptr)
-    , myVkGraphicsPipeline(nullptr)
-    , myVkCommandPool(nullptr)
+    , myVkEnabledFeatures()
+    , myVkEnabledVulkan12Features()
     , myVkGraphicsQueue(nullptr)
     , myVkPresentQueue(nullptr)
+    , myVkTransferQueue(nullptr)
+    , myVkComputeQueue(nullptr)
     , myVkSwapChain(nullptr)
     , myVkSwapChainImageFormat(VkFormat::VK_FORMAT_UNDEFINED)
     , myVkSwapChainExtent()
+    , myVkPresentMode(VK_PRESENT_MODE_FIFO_KHR)
     , myVkRenderPass(nullptr)
+    , myVkPostProcessRenderPass(nullptr)
+    , mySampleCount(VK_SAMPLE_COUNT_1_BIT)
+    , myDepthFormat(VK_FORMAT_UNDEFINED)
     , myVkPipelineLayout(nullptr)
-    , myCurrentFrameIndex(0)
+    , myVkGraphicsPipeline(nullptr)
+    , myPendingGraphicsPipeline(nullptr)
+    , myVkPostProcessPipeline(nullptr)
+    , myPendingPostProcessPipeline(nullptr)
+    , myPendingCullingPipeline(nullptr)
+    , myPendingSimulationPipeline(nullptr)
+    , myMaterialBufferHandle(BindlessDescriptors::ourInvalidHandle)
+    , myFrameUniformOffset(0)
+    , myTextureId(TextureStreamer::ourInvalidTextureId)
+    , myTextureHandle(BindlessDescriptors::ourInvalidHandle)
+    , myBackbuffer(0)
+    , myDrawSubmissionMode(aSettings.myDrawSubmissionMode)
+    , myViewProjection(glm::ortho(-1.0f / aSettings.myCameraZoom, 1.0f / aSettings.myCameraZoom, -1.0f / aSettings.myCameraZoom, 1.0f / aSettings.myCameraZoom, -1.0f, 1.0f))
+    , myJobSystem(aSettings.myJobThreadCount - 1)
+    , myVkGraphicsTimelineSemaphore(nullptr)
+    , mySubmittedFrameCount(0)
+    , myOffscreenImageIndex(0)
+    , myLastRecordTimeMs(0.0)
+    , myStartTime(std::chrono::steady_clock::now())
+    , myInitializationTimeMs(0.0)
+    , myPresentPolicy(aSettings.myPresentPolicy)
+    , myRequestedPresentPolicy(aSettings.myPresentPolicy)
+    , myUsesDynamicRendering(false)
     , myIsFramebufferResized(false)
+    , myIsTraceDumpRequested(false)
 {
-    myResourcesPath = std::filesystem::current_path().generic_string() + "/Debug/Resources/";
 }
 
 void HelloTriangleApp::Run()
 {
-    InitializeWindow();
+    if (!mySettings.myIsHeadless)
+        InitializeWindow();
+
     InitializeVulkan();
     MainLoop();
     Cleanup();
@@ -100,6 +272,7 @@ void HelloTriangleApp::InitializeWindow()
     myGLFWWindow = glfwCreateWindow(HelloTriangleAppPrivate::ourWidth, HelloTriangleAppPrivate::ourHeight, HelloTriangleAppPrivate::ourAppName, nullptr, nullptr);
     glfwSetWindowUserPointer(myGLFWWindow, this);
     glfwSetFramebufferSizeCallback(myGLFWWindow, FramebufferResizeCallback);
+    glfwSetKeyCallback(myGLFWWindow, KeyCallback);
 }
 
 void HelloTriangleApp::FramebufferResizeCallback(GLFWwindow* aWindow, int aWidth, int aHeight)
@@ -108,79 +281,415 @@ void HelloTriangleApp::FramebufferResizeCallback(GLFWwindow* aWindow, int aWidth
     helloTriangleApp->myIsFramebufferResized = true;
 }
 
+void HelloTriangleApp::KeyCallback(GLFWwindow* aWindow, int aKey, int /*aScancode*/, int anAction, int /*someModifiers*/)
+{
+    HelloTriangleApp* helloTriangleApp = reinterpret_cast<HelloTriangleApp*>(glfwGetWindowUserPointer(aWindow));
+
+    if (anAction != GLFW_PRESS)
+        return;
+
+    // F1 to F4 switch between the present policies in declaration order.
+    if (aKey >= GLFW_KEY_F1 && aKey <= GLFW_KEY_F4)
+        helloTriangleApp->myRequestedPresentPolicy = static_cast<PresentPolicy>(aKey - GLFW_KEY_F1);
+
+    if (aKey == GLFW_KEY_F12)
+        helloTriangleApp->myIsTraceDumpRequested = true;
+}
+
 void HelloTriangleApp::InitializeVulkan()
 {
-    CreateInstance();
-    SetupDebugMessenger();
-    CreateSurface();
-    PickPhysicalDevice();
-    CreateLogicalDevice();
-    CreateSwapChain();
-    CreateImageViews();
-    CreateRenderPass();
-    CreateGraphicsPipeline();
-    CreateFramebuffers();
-    CreateCommandPool();
-    CreateCommandBuffers();
-    CreateSyncObjects();
+    CPU_TRACE_ZONE("InitializeVulkan");
+
+    const std::chrono::steady_clock::time_point initializationStart = std::chrono::steady_clock::now();
+
+    // Mapping the archive is a single call; shader pages are only read when a pipeline needs them.
+    myShaderArchive.Open(mySettings.myResourcesPath + "Shaders.pak");
+
+    // The jobs below reference these locals and the device, so they must finish before an exception unwinds past them.
+    TextureData texture;
+    JobCounter textureLoad;
+    JobCounter computePipelines;
+    JobCounter graphicsPipelines;
+
+    try
+    {
+        // The texture is read and parsed while the device is created.
+        myJobSystem.Run([this, &texture]()
+        {
+            CPU_TRACE_ZONE("LoadTexture");
+            texture = LoadTexture();
+        }, textureLoad);
+
+        CreateInstance();
+        SetupDebugMessenger();
+        CreateSurface();
+        PickPhysicalDevice();
+        CreateLogicalDevice();
+        CreateMemoryAllocator();
+        CreatePipelineCache();
+        CreateBindlessDescriptors();
+        CreateFrameUniforms();
+        CreateShaderCompiler();
+
+        // Pipelines compile in jobs while the swap chain and the per-frame resources are created. Pipeline creation only
+        // touches the device and the internally synchronized pipeline cache.
+        myJobSystem.Run([this]()
+        {
+            CPU_TRACE_ZONE("CreateComputePipelines");
+            CreateGpuCuller();
+            CreateInstanceSimulation();
+        }, computePipelines);
+
+        CreateSwapChain();
+        CreateImageViews();
+
+        myDepthFormat = mySettings.myIsDepthTesting ? ChooseDepthFormat() : VK_FORMAT_UNDEFINED;
+        mySampleCount = ChooseSampleCount(mySettings.myMsaaSampleCount);
+
+        if (mySampleCount != mySettings.myMsaaSampleCount)
+            std::cout << mySettings.myMsaaSampleCount << "x MSAA is not supported, using " << mySampleCount << "x" << std::endl;
+
+        CreateRenderPass();
+        CreatePipelineLayout();
+
+        myJobSystem.Run([this]()
+        {
+            CPU_TRACE_ZONE("CreateGraphicsPipeline");
+            myVkGraphicsPipeline = CreateGraphicsPipeline();
+            myVkPostProcessPipeline = CreatePostProcessPipeline();
+        }, graphicsPipelines);
+
+        CreateRenderGraph();
+        CreateCommandPools();
+        CreateCommandBuffers();
+        CreateStagingRing();
+        CreateComputeScheduler();
+        CreateMaterials();
+
+        myJobSystem.Wait(textureLoad);
+        CreateTextures(texture);
+        CreateGeometryBuffers();
+
+        // The scene hands its buffers to the culler and the simulation.
+        myJobSystem.Wait(computePipelines);
+
+        CreateScene(mySettings.myObjectCount, mySettings.myDrawSubmissionMode);
+        CreateSyncObjects();
+        CreateGpuProfiler();
+
+        myJobSystem.Wait(graphicsPipelines);
+    }
+    catch (...)
+    {
+        for (JobCounter* counter : { &textureLoad, &computePipelines, &graphicsPipelines })
+        {
+            try
+            {
+                myJobSystem.Wait(*counter);
+            }
+            catch (...)
+            {
+                // Only the first exception is reported.
+            }
+        }
+
+        throw;
+    }
+
+    StartShaderHotReload();
+
+    myInitializationTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initializationStart).count();
 }
 
 void HelloTriangleApp::MainLoop()
 {
-    while (!glfwWindowShouldClose(myGLFWWindow))
+    if (mySettings.myIsDrawBenchmark)
+    {
+        RunDrawBenchmark();
+    }
+    else if (mySettings.myIsMsaaBenchmark)
+    {
+        RunMsaaBenchmark();
+    }
+    else
+    {
+        FrameStatistics frameStatistics;
+        FrameStatistics recordStatistics;
+        RunFrames(mySettings.myFrameCount, frameStatistics, recordStatistics);
+
+        if (mySettings.myFrameCount > 0)
+        {
+            frameStatistics.Print(std::cout, mySettings.myIsHeadless ? "Headless benchmark" : "Benchmark");
+            recordStatistics.Print(std::cout, "Command recording");
+            myGpuProfiler.Print();
+            myMemoryAllocator.PrintStatistics(std::cout);
+        }
+    }
+
+    vkDeviceWaitIdle(myVkDevice);
+
+    if (!mySettings.myGpuProfileJsonPath.empty())
+        myGpuProfiler.WriteJson(mySettings.myGpuProfileJsonPath);
+
+    if (!mySettings.myGpuProfileCsvPath.empty())
+        myGpuProfiler.WriteCsv(mySettings.myGpuProfileCsvPath);
+
+    if (CpuTracer::IsEnabled())
+        CpuTracer::WriteChromeTrace(mySettings.myTracePath);
+}
+
+bool HelloTriangleApp::RunFrames(uint32_t aFrameCount, FrameStatistics& aFrameStatistics, FrameStatistics& aRecordStatistics)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    Clock::time_point measureStart = Clock::now();
+    Clock::time_point previousFrameEnd = measureStart;
+    uint32_t frameNumber = 0;
+
+    while (mySettings.myIsHeadless || !glfwWindowShouldClose(myGLFWWindow))
     {
-        glfwPollEvents();
+        if (aFrameCount > 0 && frameNumber >= mySettings.myWarmupFrameCount + aFrameCount)
+            break;
+
+        if (!mySettings.myIsHeadless)
+        {
+            CPU_TRACE_ZONE("PollEvents");
+            glfwPollEvents();
+        }
+
+        // Warmup frames still in flight are dropped along with the samples read back so far.
+        if (frameNumber == mySettings.myWarmupFrameCount)
+            myGpuProfiler.ResetStatistics();
+
         DrawFrame();
+
+        if (mySubmittedFrameCount == 1)
+            ReportTimeToFirstFrame();
+
+        if (myIsTraceDumpRequested && CpuTracer::IsEnabled())
+        {
+            CpuTracer::WriteChromeTrace(mySettings.myTracePath);
+            std::cout << "Wrote CPU trace to " << mySettings.myTracePath << std::endl;
+        }
+
+        myIsTraceDumpRequested = false;
+
+        const Clock::time_point frameEnd = Clock::now();
+        if (frameNumber == mySettings.myWarmupFrameCount)
+            measureStart = previousFrameEnd;
+
+        if (frameNumber >= mySettings.myWarmupFrameCount)
+        {
+            aFrameStatistics.AddFrameTime(Milliseconds(frameEnd - previousFrameEnd).count());
+            aRecordStatistics.AddFrameTime(myLastRecordTimeMs);
+        }
+
+        previousFrameEnd = frameEnd;
+        frameNumber++;
     }
 
+    aFrameStatistics.SetElapsedTime(Milliseconds(previousFrameEnd - measureStart).count());
+
+    // The last frames' timestamps are only read back when their frame slot is recorded again.
     vkDeviceWaitIdle(myVkDevice);
+    myGpuProfiler.CollectPending();
+
+    return aFrameCount == 0 || frameNumber >= mySettings.myWarmupFrameCount + aFrameCount;
+}
+
+void HelloTriangleApp::RunDrawBenchmark()
+{
+    const std::pair<DrawSubmissionMode, const char*> modes[] =
+    {
+        { DrawSubmissionMode::Individual, "individual" },
+        { DrawSubmissionMode::Instanced, "instanced" },
+        { DrawSubmissionMode::Indirect, "indirect" },
+        { DrawSubmissionMode::GpuCulled, "gpu-culled" }
+    };
+
+    std::cout << std::left << std::setw(12) << "Mode" << std::right << std::setw(10) << "Objects"
+        << std::setw(14) << "Record ms" << std::setw(14) << "GPU ms" << std::setw(14) << "Frames/s" << std::endl;
+
+    for (const std::pair<DrawSubmissionMode, const char*>& mode : modes)
+    {
+        if (const char* missingFeature = GetMissingFeature(mode.first))
+        {
+            std::cout << std::left << std::setw(12) << mode.second << "skipped, " << missingFeature << " is not supported" << std::endl;
+            continue;
+        }
+
+        for (uint64_t objectCount = 1; objectCount <= mySettings.myObjectCount; objectCount *= 10)
+        {
+            vkDeviceWaitIdle(myVkDevice);
+            CreateScene(static_cast<uint32_t>(objectCount), mode.first);
+
+            FrameStatistics frameStatistics;
+            FrameStatistics recordStatistics;
+            if (!RunFrames(mySettings.myFrameCount, frameStatistics, recordStatistics))
+                return;
+
+            std::cout << std::fixed << std::setprecision(3)
+                << std::left << std::setw(12) << mode.second << std::right << std::setw(10) << objectCount
+                << std::setw(14) << recordStatistics.GetAverage()
+                << std::setw(14) << myGpuProfiler.GetAverage("Culling") + myGpuProfiler.GetAverage("MainPass")
+                << std::setw(14) << std::setprecision(1) << frameStatistics.GetFramesPerSecond()
+                << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+void HelloTriangleApp::RunMsaaBenchmark()
+{
+    // Vulkan exposes no memory bandwidth counters. Multisampled attachments that never leave tile memory show up as
+    // lazily allocated memory the device did not commit, which is the traffic that stays on chip.
+    std::cout << std::right << std::setw(8) << "Samples" << std::setw(14) << "GPU ms" << std::setw(14) << "Frames/s"
+        << std::setw(16) << "Attachment MiB" << std::setw(16) << "Committed MiB" << std::endl;
+
+    for (uint32_t sampleCount = VK_SAMPLE_COUNT_1_BIT; sampleCount <= VK_SAMPLE_COUNT_64_BIT; sampleCount *= 2)
+    {
+        if (ChooseSampleCount(sampleCount) != sampleCount)
+            continue;
+
+        RecreateRenderTargets(static_cast<VkSampleCountFlagBits>(sampleCount));
+
+        FrameStatistics frameStatistics;
+        FrameStatistics recordStatistics;
+        if (!RunFrames(mySettings.myFrameCount, frameStatistics, recordStatistics))
+            return;
+
+        const double mebibyte = 1024.0 * 1024.0;
+        std::cout << std::fixed << std::setprecision(3)
+            << std::right << std::setw(8) << sampleCount
+            << std::setw(14) << myGpuProfiler.GetAverage("MainPass")
+            << std::setw(14) << std::setprecision(1) << frameStatistics.GetFramesPerSecond()
+            << std::setw(16) << (myRenderGraph.GetTransientMemorySize() + myRenderGraph.GetLazilyAllocatedMemorySize()) / mebibyte
+            << std::setw(16) << (myRenderGraph.GetTransientMemorySize() + myRenderGraph.GetCommittedLazilyAllocatedMemorySize()) / mebibyte
+            << std::defaultfloat << std::endl;
+    }
 }
 
 void HelloTriangleApp::CleanupSwapChain()
 {
-    for (VkFramebuffer& framebuffer : myVkSwapChainFramebuffers)
-        vkDestroyFramebuffer(myVkDevice, framebuffer, nullptr);
+    myRenderGraph.Reset();
+
+    for (VkImageView& imageView : myVkSwapChainImageViews)
+        vkDestroyImageView(myVkDevice, imageView, nullptr);
 
-    vkFreeCommandBuffers(myVkDevice, myVkCommandPool, static_cast<uint32_t>(myVkCommandBuffers.size()), myVkCommandBuffers.data());
+    if (mySettings.myIsHeadless)
+    {
+        for (VkImage& image : myVkSwapChainImages)
+            vkDestroyImage(myVkDevice, image, nullptr);
+
+        for (MemoryAllocation& imageAllocation : myOffscreenImageAllocations)
+            myMemoryAllocator.Free(imageAllocation);
+
+        myVkSwapChainImages.clear();
+        myOffscreenImageAllocations.clear();
+    }
+}
 
+void HelloTriangleApp::CleanupGraphicsPipeline()
+{
+    // Only called with the device idle, so reloaded pipelines can go as well.
     vkDestroyPipeline(myVkDevice, myVkGraphicsPipeline, nullptr);
-    vkDestroyPipelineLayout(myVkDevice, myVkPipelineLayout, nullptr);
     vkDestroyRenderPass(myVkDevice, myVkRenderPass, nullptr);
+    vkDestroyRenderPass(myVkDevice, myVkPostProcessRenderPass, nullptr);
 
-    for (VkImageView& imageView : myVkSwapChainImageViews)
-        vkDestroyImageView(myVkDevice, imageView, nullptr);
+    if (myVkPostProcessPipeline)
+        vkDestroyPipeline(myVkDevice, myVkPostProcessPipeline, nullptr);
+
+    if (myPendingGraphicsPipeline)
+        vkDestroyPipeline(myVkDevice, myPendingGraphicsPipeline, nullptr);
+
+    if (myPendingPostProcessPipeline)
+        vkDestroyPipeline(myVkDevice, myPendingPostProcessPipeline, nullptr);
+
+    for (const RetiredPipeline& retiredPipeline : myRetiredPipelines)
+        vkDestroyPipeline(myVkDevice, retiredPipeline.myVkPipeline, nullptr);
 
-    vkDestroySwapchainKHR(myVkDevice, myVkSwapChain, nullptr);
+    myPendingGraphicsPipeline = nullptr;
+    myVkPostProcessPipeline = nullptr;
+    myPendingPostProcessPipeline = nullptr;
+    myVkRenderPass = nullptr;
+    myVkPostProcessRenderPass = nullptr;
+    myRetiredPipelines.clear();
 }
 
 void HelloTriangleApp::Cleanup()
 {
+    myShaderWatcher.Stop();
+
     CleanupSwapChain();
+    CleanupGraphicsPipeline();
+    vkDestroyPipelineLayout(myVkDevice, myVkPipelineLayout, nullptr);
+    myFrameUniforms.Destroy();
+    myBindlessDescriptors.Destroy();
+
+    // Compute pipelines reloaded after the last frame.
+    if (myPendingCullingPipeline)
+        vkDestroyPipeline(myVkDevice, myPendingCullingPipeline, nullptr);
+
+    if (myPendingSimulationPipeline)
+        vkDestroyPipeline(myVkDevice, myPendingSimulationPipeline, nullptr);
 
-    for (unsigned int i = 0; i < HelloTriangleAppPrivate::ourMaxFramesInFlight; i++)
+    if (myVkSwapChain)
+        vkDestroySwapchainKHR(myVkDevice, myVkSwapChain, nullptr);
+
+    for (unsigned int i = 0; i < mySettings.myFramesInFlightCount; i++)
     {
         vkDestroySemaphore(myVkDevice, myVkRenderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(myVkDevice, myVkImageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(myVkDevice, myVkInFlightFences[i], nullptr);
     }
 
-    vkDestroyCommandPool(myVkDevice, myVkCommandPool, nullptr);
+    vkDestroySemaphore(myVkDevice, myVkGraphicsTimelineSemaphore, nullptr);
+
+    for (FrameCommandBuffers& frameCommandBuffers : myFrameCommandBuffers)
+    {
+        for (VkCommandPool& commandPool : frameCommandBuffers.myVkCommandPools)
+            vkDestroyCommandPool(myVkDevice, commandPool, nullptr);
+    }
+
+    myStagingRing.Destroy();
+    DestroyScene();
+    myInstanceSimulation.Destroy();
+    myComputeScheduler.Destroy();
+    myIndexBuffer.Destroy();
+    myMaterialBuffer.Destroy();
+    myTextureStreamer.Destroy();
+    myVertexBuffer.Destroy();
+
+    myGpuCuller.Destroy();
+    myGpuProfiler.Destroy();
+
+    myPipelineCache.Save();
+    myPipelineCache.Destroy();
+
+    myMemoryAllocator.Destroy();
 
     vkDestroyDevice(myVkDevice, nullptr);
 
     if (enableValidationLayers)
         HelloTriangleAppPrivate::DestroyDebugUtilsMessengerEXT(myVkInstance, myVkDebugMessenger, nullptr);
 
-    vkDestroySurfaceKHR(myVkInstance, myVkSurface, nullptr);
+    if (myVkSurface)
+        vkDestroySurfaceKHR(myVkInstance, myVkSurface, nullptr);
+
     vkDestroyInstance(myVkInstance, nullptr);
 
-    glfwDestroyWindow(myGLFWWindow);
+    myShaderArchive.Close();
 
-    glfwTerminate();
+    if (myGLFWWindow)
+    {
+        glfwDestroyWindow(myGLFWWindow);
+        glfwTerminate();
+    }
 }
 
 void HelloTriangleApp::RecreateSwapChain()
 {
+    CPU_TRACE_ZONE("RecreateSwapChain");
+
     int width = 0, height = 0;
     glfwGetFramebufferSize(myGLFWWindow, &width, &height);
     while (width == 0 || height == 0)
@@ -191,14 +700,48 @@ void HelloTriangleApp::RecreateSwapChain()
 
     vkDeviceWaitIdle(myVkDevice);
 
+    const VkFormat previousImageFormat = myVkSwapChainImageFormat;
+
     CleanupSwapChain();
 
     CreateSwapChain();
     CreateImageViews();
+
+    // Viewport and scissor are dynamic state, so the render pass and pipelines only depend on the image format.
+    if (myVkSwapChainImageFormat != previousImageFormat)
+    {
+        // A reload in progress would build against the old render pass.
+        std::lock_guard<std::mutex> lock(myPipelineMutex);
+
+        CleanupGraphicsPipeline();
+        CreateRenderPass();
+        myVkGraphicsPipeline = CreateGraphicsPipeline();
+        myVkPostProcessPipeline = CreatePostProcessPipeline();
+    }
+
+    // Transient images follow the swap chain extent.
+    CreateRenderGraph();
+
+    // Images of the new swap chain have never been rendered to.
+    myImageTimelineValues.assign(myVkSwapChainImages.size(), 0);
+}
+
+void HelloTriangleApp::RecreateRenderTargets(VkSampleCountFlagBits aSampleCount)
+{
+    vkDeviceWaitIdle(myVkDevice);
+
+    // The sample count is baked into the render passes and the scene pipeline.
+    std::lock_guard<std::mutex> lock(myPipelineMutex);
+
+    CleanupGraphicsPipeline();
+    myRenderGraph.Reset();
+
+    mySampleCount = aSampleCount;
+
     CreateRenderPass();
-    CreateGraphicsPipeline();
-    CreateFramebuffers();
-    CreateCommandBuffers();
+    myVkGraphicsPipeline = CreateGraphicsPipeline();
+    myVkPostProcessPipeline = CreatePostProcessPipeline();
+    CreateRenderGraph();
 }
 
 void HelloTriangleApp::CreateInstance()
@@ -212,7 +755,7 @@ void HelloTriangleApp::CreateInstance()
     appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
     appInfo.pEngineName = HelloTriangleAppPrivate::ourEngineName;
     appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     VkInstanceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -264,32 +807,22 @@ void HelloTriangleApp::SetupDebugMessenger()
 
 void HelloTriangleApp::CreateSurface()
 {
+    if (mySettings.myIsHeadless)
+        return;
+
     if (glfwCreateWindowSurface(myVkInstance, myGLFWWindow, nullptr, &myVkSurface) != VK_SUCCESS)
         throw std::runtime_error("failed to create window surface!");
 }
 
 void HelloTriangleApp::PickPhysicalDevice()
 {
-    uint32_t deviceCount = 0;
-    vkEnumeratePhysicalDevices(myVkInstance, &deviceCount, nullptr);
-
-    if (deviceCount == 0)
-        throw std::runtime_error("failed to find GPUs with Vulkan support!");
+    myPhysicalDeviceSelector.Enumerate(myVkInstance);
 
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(myVkInstance, &deviceCount, devices.data());
-
-    for (const VkPhysicalDevice& device : devices)
-    {
-        if (IsDeviceSuitable(device))
-        {
-            myVkPhysicalDevice = device;
-            break;
-        }
-    }
+    const PhysicalDeviceInfo& deviceInfo = myPhysicalDeviceSelector.Select(
+        [this](const PhysicalDeviceInfo& aDeviceInfo) { return IsDeviceSuitable(aDeviceInfo.myVkPhysicalDevice); },
+        std::getenv(PhysicalDeviceSelector::ourOverrideVariableName));
 
-    if (!myVkPhysicalDevice)
-        throw std::runtime_error("failed to find a suitable GPU!");
+    myVkPhysicalDevice = deviceInfo.myVkPhysicalDevice;
 }
 
 void HelloTriangleApp::CreateLogicalDevice()
@@ -297,7 +830,7 @@ void HelloTriangleApp::CreateLogicalDevice()
     QueueFamilyIndices indices = GetQueueFamilyIndices(myVkPhysicalDevice);
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = { indices.myGraphicsFamily.value(), indices.myPresentFamily.value() };
+    std::set<uint32_t> uniqueQueueFamilies = { indices.myGraphicsFamily.value(), indices.myPresentFamily.value(), indices.myTransferFamily.value(), indices.myComputeFamily.value() };
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -310,18 +843,68 @@ void HelloTriangleApp::CreateLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    const VkPhysicalDeviceFeatures& supportedFeatures = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice).myFeatures;
+
+    // Indirect draws carry the object index in firstInstance, and batch all objects into one call when possible.
+    // Shaders pick bindless buffers and images with handles from push constants. BCn textures are streamed when supported.
     VkPhysicalDeviceFeatures deviceFeatures = {};
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    deviceFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+    deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+    deviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    myVkEnabledFeatures = deviceFeatures;
+
+    const VkPhysicalDeviceVulkan12Features& supportedVulkan12Features = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice).myVulkan12Features;
+
+    // Frames are paced with timeline semaphores, GPU culling writes its own draw count, and shaders index a single
+    // update-after-bind descriptor set.
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    vulkan12Features.drawIndirectCount = supportedVulkan12Features.drawIndirectCount;
+    vulkan12Features.descriptorIndexing = supportedVulkan12Features.descriptorIndexing;
+    vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    myVkEnabledVulkan12Features = vulkan12Features;
+
+    const PhysicalDeviceInfo& deviceInfo = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice);
+    myUsesDynamicRendering = mySettings.myIsDynamicRendering && deviceInfo.myDynamicRenderingFeatures.dynamicRendering;
+
+    if (mySettings.myIsDynamicRendering && !myUsesDynamicRendering)
+        std::cout << "Dynamic rendering is not supported, using render passes" << std::endl;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+    if (myUsesDynamicRendering)
+        vulkan12Features.pNext = &dynamicRenderingFeatures;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &vulkan12Features;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(HelloTriangleAppPrivate::ourDeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = HelloTriangleAppPrivate::ourDeviceExtensions.data();
+    std::vector<const char*> deviceExtensions = GetRequiredDeviceExtensions();
+    if (myUsesDynamicRendering)
+        deviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+    // Only reports whether pipelines hit the pipeline cache.
+    if (deviceInfo.HasExtension(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME))
+        deviceExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
     if (enableValidationLayers)
     {
@@ -338,19 +921,38 @@ void HelloTriangleApp::CreateLogicalDevice()
 
     vkGetDeviceQueue(myVkDevice, indices.myGraphicsFamily.value(), 0, &myVkGraphicsQueue);
     vkGetDeviceQueue(myVkDevice, indices.myPresentFamily.value(), 0, &myVkPresentQueue);
+    vkGetDeviceQueue(myVkDevice, indices.myTransferFamily.value(), 0, &myVkTransferQueue);
+    vkGetDeviceQueue(myVkDevice, indices.myComputeFamily.value(), 0, &myVkComputeQueue);
+}
+
+void HelloTriangleApp::CreateMemoryAllocator()
+{
+    myMemoryAllocator.Create(myVkDevice, myVkPhysicalDevice);
+}
+
+void HelloTriangleApp::CreatePipelineCache()
+{
+    const PhysicalDeviceInfo& deviceInfo = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice);
+
+    // Enabled by CreateLogicalDevice whenever the device supports it.
+    const bool isCreationFeedbackEnabled = deviceInfo.HasExtension(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    myPipelineCache.Create(myVkDevice, deviceInfo.myProperties, std::filesystem::current_path().generic_string() + "/PipelineCache/", isCreationFeedbackEnabled);
 }
 
 void HelloTriangleApp::CreateSwapChain()
 {
+    if (mySettings.myIsHeadless)
+    {
+        CreateOffscreenImages();
+        return;
+    }
+
     SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(myVkPhysicalDevice);
 
     VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.myFormats);
     VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.myPresentModes);
     VkExtent2D extent = ChooseSwapExtent(swapChainSupport.myCapabilities);
-
-    uint32_t imageCount = swapChainSupport.myCapabilities.minImageCount + 1;
-    if (swapChainSupport.myCapabilities.maxImageCount > 0 && imageCount > swapChainSupport.myCapabilities.maxImageCount)
-        imageCount = swapChainSupport.myCapabilities.maxImageCount;
+    uint32_t imageCount = ChooseSwapImageCount(presentMode, swapChainSupport.myCapabilities);
 
     VkSwapchainCreateInfoKHR createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -382,17 +984,64 @@ void HelloTriangleApp::CreateSwapChain()
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
 
+    // The old swap chain is handed to the driver so it can recycle its resources on resize.
+    VkSwapchainKHR oldSwapChain = myVkSwapChain;
+    createInfo.oldSwapchain = oldSwapChain;
+
     if (vkCreateSwapchainKHR(myVkDevice, &createInfo, nullptr, &myVkSwapChain) != VK_SUCCESS)
         throw std::runtime_error("failed to create swap chain!");
 
+    if (oldSwapChain)
+        vkDestroySwapchainKHR(myVkDevice, oldSwapChain, nullptr);
+
+    const size_t previousImageCount = myVkSwapChainImages.size();
+
     vkGetSwapchainImagesKHR(myVkDevice, myVkSwapChain, &imageCount, nullptr);
     myVkSwapChainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(myVkDevice, myVkSwapChain, &imageCount, myVkSwapChainImages.data());
 
+    // Resizes keep the negotiated mode, so only log when it changes.
+    if (!oldSwapChain || presentMode != myVkPresentMode || imageCount != previousImageCount)
+        std::cout << "Presenting with " << HelloTriangleAppPrivate::GetPresentModeName(presentMode) << " and " << imageCount << " swap chain images (" << HelloTriangleAppPrivate::GetPresentPolicyName(myPresentPolicy) << " policy)" << std::endl;
+
+    myVkPresentMode = presentMode;
+
     myVkSwapChainImageFormat = surfaceFormat.format;
     myVkSwapChainExtent = extent;
 }
 
+void HelloTriangleApp::CreateOffscreenImages()
+{
+    myVkSwapChainImageFormat = HelloTriangleAppPrivate::ourOffscreenImageFormat;
+    myVkSwapChainExtent = { HelloTriangleAppPrivate::ourWidth, HelloTriangleAppPrivate::ourHeight };
+
+    myVkSwapChainImages.resize(HelloTriangleAppPrivate::ourOffscreenImageCount);
+    myOffscreenImageAllocations.resize(HelloTriangleAppPrivate::ourOffscreenImageCount);
+
+    for (unsigned int i = 0; i < myVkSwapChainImages.size(); i++)
+    {
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = myVkSwapChainImageFormat;
+        imageInfo.extent.width = myVkSwapChainExtent.width;
+        imageInfo.extent.height = myVkSwapChainExtent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(myVkDevice, &imageInfo, nullptr, &myVkSwapChainImages[i]) != VK_SUCCESS)
+            throw std::runtime_error("failed to create offscreen image!");
+
+        myOffscreenImageAllocations[i] = myMemoryAllocator.AllocateForImage(myVkSwapChainImages[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+}
+
 void HelloTriangleApp::CreateImageViews()
 {
     myVkSwapChainImageViews.resize(myVkSwapChainImages.size());
@@ -419,55 +1068,182 @@ void HelloTriangleApp::CreateImageViews()
     }
 }
 
+void HelloTriangleApp::CreateBindlessDescriptors()
+{
+    myBindlessDescriptors.Create(myVkDevice, myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice).myDescriptorIndexingProperties);
+}
+
+void HelloTriangleApp::CreateFrameUniforms()
+{
+    myFrameUniforms.Create(myVkDevice, myMemoryAllocator, myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice).myProperties.limits, HelloTriangleAppPrivate::ourFrameUniformCapacity, mySettings.myFramesInFlightCount, sizeof(HelloTriangleAppPrivate::FrameUniforms), VK_SHADER_STAGE_VERTEX_BIT);
+}
+
+void HelloTriangleApp::CreateShaderCompiler()
+{
+    if (mySettings.myShaderSourcePath.empty())
+        return;
+
+    myShaderCompiler.Create(mySettings.myShaderSourcePath, std::filesystem::current_path().generic_string() + "/ShaderCache/");
+}
+
 void HelloTriangleApp::CreateRenderPass()
 {
-    VkAttachmentDescription colorAttachment = {};
+    if (myUsesDynamicRendering)
+        return;
+
+    // Never begun: the render graph creates the render passes it executes, and pipelines only need a compatible one,
+    // which load and store ops and layouts do not affect. Attachment formats, sample counts and resolve attachments do.
+    VkAttachmentDescription attachmentTemplate = {};
+    attachmentTemplate.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachmentTemplate.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachmentTemplate.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachmentTemplate.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    VkAttachmentDescription colorAttachment = attachmentTemplate;
     colorAttachment.format = myVkSwapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.samples = mySampleCount;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentDescription resolveAttachment = colorAttachment;
+    resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkAttachmentDescription depthAttachment = attachmentTemplate;
+    depthAttachment.format = myDepthFormat;
+    depthAttachment.samples = mySampleCount;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    std::vector<VkAttachmentDescription> attachments = { colorAttachment };
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference resolveAttachmentRef = {};
+    resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthAttachmentRef = {};
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass = {};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
 
-    VkSubpassDependency dependency = {};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    if (mySampleCount != VK_SAMPLE_COUNT_1_BIT)
+    {
+        resolveAttachmentRef.attachment = static_cast<uint32_t>(attachments.size());
+        attachments.push_back(resolveAttachment);
+        subpass.pResolveAttachments = &resolveAttachmentRef;
+    }
+
+    if (myDepthFormat != VK_FORMAT_UNDEFINED)
+    {
+        depthAttachmentRef.attachment = static_cast<uint32_t>(attachments.size());
+        attachments.push_back(depthAttachment);
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    }
 
     VkRenderPassCreateInfo renderPassInfo = {};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
 
     if (vkCreateRenderPass(myVkDevice, &renderPassInfo, nullptr, &myVkRenderPass) != VK_SUCCESS)
         throw std::runtime_error("failed to create render pass!");
-}
 
-void HelloTriangleApp::CreateGraphicsPipeline()
-{
-    std::vector<char> vertShaderCode = ReadFile(myResourcesPath + "Shaders/vert.spv");
-    std::vector<char> fragShaderCode = ReadFile(myResourcesPath + "Shaders/frag.spv");
+    if (!mySettings.myIsPostProcessing)
+        return;
 
-    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
+    // Post-processing passes write a single single-sampled color attachment.
+    subpass.pResolveAttachments = nullptr;
+    subpass.pDepthStencilAttachment = nullptr;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &resolveAttachment;
+
+    if (vkCreateRenderPass(myVkDevice, &renderPassInfo, nullptr, &myVkPostProcessRenderPass) != VK_SUCCESS)
+        throw std::runtime_error("failed to create post-process render pass!");
+}
+
+VkFormat HelloTriangleApp::ChooseDepthFormat() const
+{
+    // The scene needs no stencil, and 32-bit float depth is the most precise.
+    const VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM };
+
+    for (VkFormat format : candidates)
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(myVkPhysicalDevice, format, &properties);
+
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+            return format;
+    }
+
+    throw std::runtime_error("failed to find a supported depth format!");
+}
+
+VkSampleCountFlagBits HelloTriangleApp::ChooseSampleCount(uint32_t aRequestedCount) const
+{
+    const VkPhysicalDeviceLimits& limits = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice).myProperties.limits;
+
+    VkSampleCountFlags supportedCounts = limits.framebufferColorSampleCounts;
+    if (myDepthFormat != VK_FORMAT_UNDEFINED)
+        supportedCounts &= limits.framebufferDepthSampleCounts;
+
+    // The largest supported count not above the request. One sample is always supported.
+    uint32_t sampleCount = aRequestedCount;
+    while (sampleCount > 1 && !(supportedCounts & sampleCount))
+        sampleCount /= 2;
+
+    return static_cast<VkSampleCountFlagBits>(sampleCount);
+}
+
+void HelloTriangleApp::CreatePipelineLayout()
+{
+    VkPushConstantRange sceneConstantRange = {};
+    sceneConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    sceneConstantRange.offset = 0;
+    sceneConstantRange.size = sizeof(HelloTriangleAppPrivate::SceneConstants);
+
+    // Set 0 is the bindless set, set 1 the per-frame uniforms.
+    VkDescriptorSetLayout setLayouts[] = { myBindlessDescriptors.GetVkDescriptorSetLayout(), myFrameUniforms.GetVkDescriptorSetLayout() };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &sceneConstantRange;
+
+    if (vkCreatePipelineLayout(myVkDevice, &pipelineLayoutInfo, nullptr, &myVkPipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create pipeline layout!");
+}
+
+VkPipeline HelloTriangleApp::CreateGraphicsPipeline()
+{
+    return CreatePipeline("shader.vert", "shader.frag", GetSceneVertexLayout().GetVertexInputStateCreateInfo(), VK_CULL_MODE_BACK_BIT, myVkRenderPass, mySampleCount, myDepthFormat, "Triangle");
+}
+
+VkPipeline HelloTriangleApp::CreatePostProcessPipeline()
+{
+    if (!mySettings.myIsPostProcessing)
+        return nullptr;
+
+    // Fullscreen triangles are generated from the vertex index.
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    return CreatePipeline("post.vert", "post.frag", vertexInputInfo, VK_CULL_MODE_NONE, myVkPostProcessRenderPass, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_UNDEFINED, "PostProcess");
+}
+
+VkPipeline HelloTriangleApp::CreatePipeline(const std::string& aVertexShader, const std::string& aFragmentShader, const VkPipelineVertexInputStateCreateInfo& aVertexInputInfo, VkCullModeFlags aCullMode,
+    VkRenderPass aRenderPass, VkSampleCountFlagBits aSampleCount, VkFormat aDepthFormat, const std::string& aName)
+{
+    VkShaderModule vertShaderModule = LoadShaderModule(aVertexShader);
+    VkShaderModule fragShaderModule = LoadShaderModule(aFragmentShader);
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -483,34 +1259,22 @@ void HelloTriangleApp::CreateGraphicsPipeline()
 
     VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-
     VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport = {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(myVkSwapChainExtent.width);
-    viewport.height = static_cast<float>(myVkSwapChainExtent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {};
-    scissor.offset = { 0, 0 };
-    scissor.extent = myVkSwapChainExtent;
-
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
+
+    VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
 
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -518,14 +1282,23 @@ void HelloTriangleApp::CreateGraphicsPipeline()
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.cullMode = aCullMode;
     rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
 
     VkPipelineMultisampleStateCreateInfo multisampling = {};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = aSampleCount;
+
+    // Objects at equal depth keep their draw order.
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -542,191 +1315,884 @@ void HelloTriangleApp::CreateGraphicsPipeline()
     colorBlending.blendConstants[2] = 0.0f;
     colorBlending.blendConstants[3] = 0.0f;
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-
-    if (vkCreatePipelineLayout(myVkDevice, &pipelineLayoutInfo, nullptr, &myVkPipelineLayout) != VK_SUCCESS)
-        throw std::runtime_error("failed to create pipeline layout!");
-
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pVertexInputState = &aVertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = aDepthFormat != VK_FORMAT_UNDEFINED ? &depthStencil : nullptr;
     pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = myVkPipelineLayout;
-    pipelineInfo.renderPass = myVkRenderPass;
+    pipelineInfo.renderPass = aRenderPass;
+
+    VkPipelineRenderingCreateInfoKHR renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &myVkSwapChainImageFormat;
+    renderingInfo.depthAttachmentFormat = aDepthFormat;
+
+    if (myUsesDynamicRendering)
+        pipelineInfo.pNext = &renderingInfo;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = nullptr;
 
-    if (vkCreateGraphicsPipelines(myVkDevice, nullptr, 1, &pipelineInfo, nullptr, &myVkGraphicsPipeline) != VK_SUCCESS)
-        throw std::runtime_error("failed to create graphics pipeline!");
+    PipelineCreationFeedback feedback;
+    pipelineInfo.pNext = myPipelineCache.ChainCreationFeedback(feedback, pipelineInfo.pNext);
+
+    const std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline = nullptr;
+    const VkResult result = vkCreateGraphicsPipelines(myVkDevice, myPipelineCache.GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
 
     vkDestroyShaderModule(myVkDevice, fragShaderModule, nullptr);
     vkDestroyShaderModule(myVkDevice, vertShaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create graphics pipeline!");
+
+    myPipelineCache.RecordCreationTime(aName, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - creationStart).count(), feedback);
+
+    return pipeline;
 }
 
-void HelloTriangleApp::CreateFramebuffers()
+void HelloTriangleApp::CreateGpuCuller()
 {
-    myVkSwapChainFramebuffers.resize(myVkSwapChainImageViews.size());
+    if (!myVkEnabledVulkan12Features.drawIndirectCount || !myVkEnabledFeatures.drawIndirectFirstInstance)
+        return;
+
+    std::vector<uint32_t> spirv;
+    myGpuCuller.Create(myVkDevice, myPipelineCache, GetShaderCode("cull.comp", spirv), mySettings.myFramesInFlightCount);
+}
 
-    for (unsigned int i = 0; i < myVkSwapChainImageViews.size(); i++)
+void HelloTriangleApp::CreateRenderGraph()
+{
+    myRenderGraph.Create(myMemoryAllocator, myBindlessDescriptors, myUsesDynamicRendering);
+
+    const VkImageLayout backbufferLayout = mySettings.myIsHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    myBackbuffer = myRenderGraph.ImportImage("Backbuffer", myVkSwapChainImageFormat, myVkSwapChainExtent, backbufferLayout);
+
+    const VkClearColorValue clearColor = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+    const uint32_t mainPass = myRenderGraph.AddPass("MainPass", [this](const RenderPassContext& aContext) { RecordMainPass(aContext); }, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    // The main pass renders into the backbuffer, or into the scene color that post-processing reads.
+    const RenderGraphResource sceneColor = mySettings.myIsPostProcessing ? myRenderGraph.CreateImage("SceneColor", myVkSwapChainImageFormat, myVkSwapChainExtent) : myBackbuffer;
+
+    // Multisampled color and depth only live within the main pass, which resolves the color before it ends.
+    if (mySampleCount != VK_SAMPLE_COUNT_1_BIT)
     {
-        VkImageView attachments[] =
-        {
-            myVkSwapChainImageViews[i]
-        };
+        const RenderGraphResource multisampledColor = myRenderGraph.CreateImage("MultisampledColor", myVkSwapChainImageFormat, myVkSwapChainExtent, mySampleCount);
+        myRenderGraph.WriteColor(mainPass, multisampledColor, &clearColor);
+        myRenderGraph.ResolveColor(mainPass, multisampledColor, sceneColor);
+    }
+    else
+    {
+        myRenderGraph.WriteColor(mainPass, sceneColor, &clearColor);
+    }
 
-        VkFramebufferCreateInfo framebufferInfo = {};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = myVkRenderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = myVkSwapChainExtent.width;
-        framebufferInfo.height = myVkSwapChainExtent.height;
-        framebufferInfo.layers = 1;
+    if (myDepthFormat != VK_FORMAT_UNDEFINED)
+    {
+        const VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+        const RenderGraphResource depth = myRenderGraph.CreateImage("Depth", myDepthFormat, myVkSwapChainExtent, mySampleCount);
+        myRenderGraph.WriteDepth(mainPass, depth, &clearDepth);
+    }
 
-        if (vkCreateFramebuffer(myVkDevice, &framebufferInfo, nullptr, &myVkSwapChainFramebuffers[i]) != VK_SUCCESS)
-            throw std::runtime_error("failed to create framebuffer!");
+    if (mySettings.myIsPostProcessing)
+    {
+        // A separable blur followed by a vignette. The scene color and the blurred image are never alive at the same
+        // time, so they share memory.
+        const RenderGraphResource blurTemp = myRenderGraph.CreateImage("BlurTemp", myVkSwapChainImageFormat, myVkSwapChainExtent);
+        const RenderGraphResource blurred = myRenderGraph.CreateImage("Blurred", myVkSwapChainImageFormat, myVkSwapChainExtent);
+
+        const uint32_t blurHorizontalPass = myRenderGraph.AddPass("BlurH", [this, sceneColor](const RenderPassContext& aContext) { RecordPostProcessPass(aContext, sceneColor, 0); });
+        myRenderGraph.ReadSampled(blurHorizontalPass, sceneColor);
+        myRenderGraph.WriteColor(blurHorizontalPass, blurTemp);
+
+        const uint32_t blurVerticalPass = myRenderGraph.AddPass("BlurV", [this, blurTemp](const RenderPassContext& aContext) { RecordPostProcessPass(aContext, blurTemp, 1); });
+        myRenderGraph.ReadSampled(blurVerticalPass, blurTemp);
+        myRenderGraph.WriteColor(blurVerticalPass, blurred);
+
+        const uint32_t vignettePass = myRenderGraph.AddPass("Vignette", [this, blurred](const RenderPassContext& aContext) { RecordPostProcessPass(aContext, blurred, 2); });
+        myRenderGraph.ReadSampled(vignettePass, blurred);
+        myRenderGraph.WriteColor(vignettePass, myBackbuffer);
     }
+
+    myRenderGraph.Compile();
+
+    std::cout << "Render graph: " << myRenderGraph.GetExecutedPassCount() << " passes, " << myRenderGraph.GetBarrierCount() << " barriers, "
+        << myRenderGraph.GetTransientMemorySize() / 1024 << " KiB transient memory (" << myRenderGraph.GetUnaliasedTransientMemorySize() / 1024 << " KiB without aliasing), "
+        << myRenderGraph.GetLazilyAllocatedMemorySize() / 1024 << " KiB lazily allocated (" << myRenderGraph.GetCommittedLazilyAllocatedMemorySize() / 1024 << " KiB committed)" << std::endl;
 }
 
-void HelloTriangleApp::CreateCommandPool()
+void HelloTriangleApp::CreateCommandPools()
 {
     QueueFamilyIndices queueFamilyIndices = GetQueueFamilyIndices(myVkPhysicalDevice);
 
     VkCommandPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
     poolInfo.queueFamilyIndex = queueFamilyIndices.myGraphicsFamily.value();
 
-    if (vkCreateCommandPool(myVkDevice, &poolInfo, nullptr, &myVkCommandPool) != VK_SUCCESS)
-        throw std::runtime_error("failed to create command pool!");
+    myFrameCommandBuffers.resize(mySettings.myFramesInFlightCount);
+
+    for (FrameCommandBuffers& frameCommandBuffers : myFrameCommandBuffers)
+    {
+        frameCommandBuffers.myVkCommandPools.resize(mySettings.myRecordingThreadCount);
+
+        for (VkCommandPool& commandPool : frameCommandBuffers.myVkCommandPools)
+        {
+            if (vkCreateCommandPool(myVkDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+                throw std::runtime_error("failed to create command pool!");
+        }
+    }
 }
 
 void HelloTriangleApp::CreateCommandBuffers()
 {
-    myVkCommandBuffers.resize(myVkSwapChainFramebuffers.size());
+    for (FrameCommandBuffers& frameCommandBuffers : myFrameCommandBuffers)
+    {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = frameCommandBuffers.myVkCommandPools[0];
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
 
-    VkCommandBufferAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = myVkCommandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = (uint32_t)myVkCommandBuffers.size();
+        if (vkAllocateCommandBuffers(myVkDevice, &allocInfo, &frameCommandBuffers.myVkPrimaryCommandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate command buffers!");
+
+        frameCommandBuffers.myVkSecondaryCommandBuffers.resize(frameCommandBuffers.myVkCommandPools.size());
+
+        for (unsigned int i = 0; i < frameCommandBuffers.myVkCommandPools.size(); i++)
+        {
+            allocInfo.commandPool = frameCommandBuffers.myVkCommandPools[i];
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
 
-    if (vkAllocateCommandBuffers(myVkDevice, &allocInfo, myVkCommandBuffers.data()) != VK_SUCCESS)
-        throw std::runtime_error("failed to allocate command buffers!");
+            if (vkAllocateCommandBuffers(myVkDevice, &allocInfo, &frameCommandBuffers.myVkSecondaryCommandBuffers[i]) != VK_SUCCESS)
+                throw std::runtime_error("failed to allocate command buffers!");
+        }
+    }
+}
+
+void HelloTriangleApp::CreateStagingRing()
+{
+    QueueFamilyIndices indices = GetQueueFamilyIndices(myVkPhysicalDevice);
+    myStagingRing.Create(myMemoryAllocator, myVkTransferQueue, indices.myTransferFamily.value(), myVkGraphicsQueue, indices.myGraphicsFamily.value(), HelloTriangleAppPrivate::ourStagingRingCapacity);
 
-    for (unsigned int i = 0; i < myVkCommandBuffers.size(); i++)
+    if (indices.myTransferFamily != indices.myGraphicsFamily)
+        std::cout << "Uploading on dedicated transfer queue family " << indices.myTransferFamily.value() << std::endl;
+}
+
+void HelloTriangleApp::CreateComputeScheduler()
+{
+    QueueFamilyIndices indices = GetQueueFamilyIndices(myVkPhysicalDevice);
+    myComputeScheduler.Create(myVkDevice, myVkComputeQueue, indices.myComputeFamily.value(), mySettings.myFramesInFlightCount);
+}
+
+void HelloTriangleApp::CreateInstanceSimulation()
+{
+    if (!mySettings.myIsSimulating)
+        return;
+
+    QueueFamilyIndices indices = GetQueueFamilyIndices(myVkPhysicalDevice);
+    std::vector<uint32_t> spirv;
+    myInstanceSimulation.Create(myVkDevice, myPipelineCache, GetShaderCode("simulate.comp", spirv), mySettings.myFramesInFlightCount);
+
+    if (indices.myComputeFamily != indices.myGraphicsFamily)
+        std::cout << "Simulating on dedicated compute queue family " << indices.myComputeFamily.value() << std::endl;
+}
+
+void HelloTriangleApp::CreateMaterials()
+{
+    const VkDeviceSize materialBufferSize = sizeof(glm::vec4) * HelloTriangleAppPrivate::ourMaterialColors.size();
+
+    myMaterialBuffer.Create(myMemoryAllocator, materialBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    myMaterialBufferHandle = myBindlessDescriptors.AddStorageBuffer(myMaterialBuffer.GetVkBuffer());
+
+    // Flushed together with the geometry.
+    myStagingRing.Upload(myMaterialBuffer, 0, HelloTriangleAppPrivate::ourMaterialColors.data(), materialBufferSize);
+}
+
+TextureData HelloTriangleApp::LoadTexture()
+{
+    TextureData texture;
+    if (!mySettings.myTexturePath.empty())
+    {
+        std::ifstream file(mySettings.myTexturePath, std::ios::binary);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open texture " + mySettings.myTexturePath + "!");
+
+        myTextureSourceData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        texture = ParseKtx2(myTextureSourceData.data(), myTextureSourceData.size());
+    }
+    else
+    {
+        // Light and dark squares, so the material tints stay visible; the GPU builds the mip chain.
+        const uint32_t size = HelloTriangleAppPrivate::ourCheckerboardSize;
+        myTextureSourceData.resize(static_cast<size_t>(size) * size * 4);
+
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                const bool isLight = ((x / HelloTriangleAppPrivate::ourCheckerboardSquareSize) + (y / HelloTriangleAppPrivate::ourCheckerboardSquareSize)) % 2 == 0;
+                std::memset(&myTextureSourceData[(static_cast<size_t>(y) * size + x) * 4], isLight ? 255 : 160, 4);
+            }
+        }
+
+        texture.myFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        texture.myLevels.push_back({ myTextureSourceData.data(), myTextureSourceData.size(), size, size });
+        texture.myGeneratesMips = true;
+    }
+
+    return texture;
+}
+
+void HelloTriangleApp::CreateTextures(const TextureData& aTexture)
+{
+    const PhysicalDeviceInfo& deviceInfo = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice);
+    const VkDeviceSize memoryBudget = static_cast<VkDeviceSize>(mySettings.myTextureBudgetMiB) * 1024 * 1024;
+    myTextureStreamer.Create(myVkPhysicalDevice, myVkEnabledFeatures, deviceInfo.myProperties.limits, myMemoryAllocator, myBindlessDescriptors, mySettings.myFramesInFlightCount, HelloTriangleAppPrivate::ourTextureUploadBudget, memoryBudget);
+
+    myTextureId = myTextureStreamer.Request(aTexture);
+}
+
+void HelloTriangleApp::CreateGeometryBuffers()
+{
+    const VkDeviceSize vertexBufferSize = sizeof(Vertex) * HelloTriangleAppPrivate::ourTriangleVertices.size();
+    const VkDeviceSize indexBufferSize = sizeof(uint16_t) * HelloTriangleAppPrivate::ourTriangleIndices.size();
+
+    myVertexBuffer.Create(myMemoryAllocator, vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    myIndexBuffer.Create(myMemoryAllocator, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // The first frame draws this geometry, so wait for it to be handed over to the graphics queue.
+    myStagingRing.Upload(myVertexBuffer, 0, HelloTriangleAppPrivate::ourTriangleVertices.data(), vertexBufferSize);
+    myStagingRing.Upload(myIndexBuffer, 0, HelloTriangleAppPrivate::ourTriangleIndices.data(), indexBufferSize);
+    myStagingRing.Flush();
+    myStagingRing.WaitIdle();
+}
+
+const char* HelloTriangleApp::GetMissingFeature(DrawSubmissionMode aMode) const
+{
+    if ((aMode == DrawSubmissionMode::Indirect || aMode == DrawSubmissionMode::GpuCulled) && !myVkEnabledFeatures.drawIndirectFirstInstance)
+        return "drawIndirectFirstInstance";
+
+    if (aMode == DrawSubmissionMode::GpuCulled && !myVkEnabledVulkan12Features.drawIndirectCount)
+        return "drawIndirectCount";
+
+    return nullptr;
+}
+
+void HelloTriangleApp::CreateScene(uint32_t anObjectCount, DrawSubmissionMode aMode)
+{
+    if (const char* missingFeature = GetMissingFeature(aMode))
+        throw std::runtime_error(std::string("draw submission mode needs the ") + missingFeature + " feature!");
+
+    DestroyScene();
+
+    myDrawSubmissionMode = aMode;
+
+    // Objects are laid out on a square grid covering the viewport.
+    const uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(anObjectCount))));
+    const float cellSize = 2.0f / static_cast<float>(gridSize);
+
+    const uint32_t indexCount = static_cast<uint32_t>(HelloTriangleAppPrivate::ourTriangleIndices.size());
+
+    myDrawCommands.clear();
+    if (aMode == DrawSubmissionMode::Instanced)
+    {
+        myDrawCommands.push_back({ indexCount, anObjectCount, 0, 0, 0 });
+    }
+    else
     {
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        myDrawCommands.reserve(anObjectCount);
+        for (uint32_t i = 0; i < anObjectCount; i++)
+            myDrawCommands.push_back({ indexCount, 1, 0, 0, i });
+    }
 
-        if (vkBeginCommandBuffer(myVkCommandBuffers[i], &beginInfo) != VK_SUCCESS)
-            throw std::runtime_error("failed to begin recording command buffer!");
+    // The culling shader reads instances as a tightly packed float array.
+    static_assert(sizeof(InstanceData) == 3 * sizeof(float), "InstanceData must be tightly packed");
 
-        VkRenderPassBeginInfo renderPassInfo = {};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = myVkRenderPass;
-        renderPassInfo.framebuffer = myVkSwapChainFramebuffers[i];
-        renderPassInfo.renderArea.offset = { 0, 0 };
-        renderPassInfo.renderArea.extent = myVkSwapChainExtent;
+    // Simulated instances are written every frame by the compute queue into one buffer per frame in flight.
+    std::vector<VkBuffer> instanceBuffers;
+    if (mySettings.myIsSimulating)
+    {
+        QueueFamilyIndices indices = GetQueueFamilyIndices(myVkPhysicalDevice);
+        myInstanceSimulation.SetScene(myMemoryAllocator, anObjectCount, gridSize, cellSize, { indices.myGraphicsFamily.value(), indices.myComputeFamily.value() });
 
-        VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues = &clearColor;
+        for (uint32_t i = 0; i < mySettings.myFramesInFlightCount; i++)
+            instanceBuffers.push_back(myInstanceSimulation.GetInstanceBuffer(i).GetVkBuffer());
+    }
+    else
+    {
+        std::vector<InstanceData> instances(anObjectCount);
+        for (uint32_t i = 0; i < anObjectCount; i++)
+        {
+            instances[i].myOffset = glm::vec2(-1.0f + cellSize * (static_cast<float>(i % gridSize) + 0.5f), -1.0f + cellSize * (static_cast<float>(i / gridSize) + 0.5f));
+            instances[i].myScale = cellSize * 0.5f;
+        }
 
-        vkCmdBeginRenderPass(myVkCommandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        const VkDeviceSize instanceBufferSize = sizeof(InstanceData) * instances.size();
+        myInstanceBuffer.Create(myMemoryAllocator, instanceBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        myStagingRing.Upload(myInstanceBuffer, 0, instances.data(), instanceBufferSize);
 
-        vkCmdBindPipeline(myVkCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, myVkGraphicsPipeline);
+        instanceBuffers.push_back(myInstanceBuffer.GetVkBuffer());
+    }
 
-        vkCmdDraw(myVkCommandBuffers[i], 3, 1, 0, 0);
+    if (aMode == DrawSubmissionMode::Indirect || aMode == DrawSubmissionMode::GpuCulled)
+    {
+        static_assert(sizeof(DrawCommand) == sizeof(VkDrawIndexedIndirectCommand), "DrawCommand must match VkDrawIndexedIndirectCommand");
 
-        vkCmdEndRenderPass(myVkCommandBuffers[i]);
+        const VkDeviceSize indirectBufferSize = sizeof(DrawCommand) * myDrawCommands.size();
+        myIndirectBuffer.Create(myMemoryAllocator, indirectBufferSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        myStagingRing.Upload(myIndirectBuffer, 0, myDrawCommands.data(), indirectBufferSize);
+    }
 
-        if (vkEndCommandBuffer(myVkCommandBuffers[i]) != VK_SUCCESS)
-            throw std::runtime_error("failed to record command buffer!");
+    if (aMode == DrawSubmissionMode::GpuCulled)
+    {
+        float boundingRadius = 0.0f;
+        for (const Vertex& vertex : HelloTriangleAppPrivate::ourTriangleVertices)
+            boundingRadius = std::max(boundingRadius, glm::length(vertex.myPosition));
+
+        myGpuCuller.SetScene(myMemoryAllocator, instanceBuffers, myIndirectBuffer, anObjectCount, boundingRadius);
     }
+
+    myStagingRing.Flush();
+    myStagingRing.WaitIdle();
+}
+
+void HelloTriangleApp::DestroyScene()
+{
+    myGpuCuller.DestroyScene();
+    myInstanceSimulation.DestroyScene();
+    myIndirectBuffer.Destroy();
+    myInstanceBuffer.Destroy();
+    myDrawCommands.clear();
 }
 
 void HelloTriangleApp::CreateSyncObjects()
 {
-    myVkImageAvailableSemaphores.resize(HelloTriangleAppPrivate::ourMaxFramesInFlight);
-    myVkRenderFinishedSemaphores.resize(HelloTriangleAppPrivate::ourMaxFramesInFlight);
-    myVkInFlightFences.resize(HelloTriangleAppPrivate::ourMaxFramesInFlight);
-    myVkImagesInFlight.resize(myVkSwapChainImages.size(), nullptr);
+    // Swap chain acquire and present only take binary semaphores, everything else waits on the graphics timeline.
+    myVkImageAvailableSemaphores.resize(mySettings.myFramesInFlightCount);
+    myVkRenderFinishedSemaphores.resize(mySettings.myFramesInFlightCount);
+    myImageTimelineValues.assign(myVkSwapChainImages.size(), 0);
 
     VkSemaphoreCreateInfo semaphoreInfo = {};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo = {};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (unsigned int i = 0; i < HelloTriangleAppPrivate::ourMaxFramesInFlight; i++)
+    for (unsigned int i = 0; i < mySettings.myFramesInFlightCount; i++)
     {
         if (vkCreateSemaphore(myVkDevice, &semaphoreInfo, nullptr, &myVkImageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(myVkDevice, &semaphoreInfo, nullptr, &myVkRenderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(myVkDevice, &fenceInfo, nullptr, &myVkInFlightFences[i]) != VK_SUCCESS)
+            vkCreateSemaphore(myVkDevice, &semaphoreInfo, nullptr, &myVkRenderFinishedSemaphores[i]) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
     }
+
+    VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {};
+    semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphoreTypeInfo.initialValue = 0;
+
+    semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+    if (vkCreateSemaphore(myVkDevice, &semaphoreInfo, nullptr, &myVkGraphicsTimelineSemaphore) != VK_SUCCESS)
+        throw std::runtime_error("failed to create graphics timeline semaphore!");
+}
+
+void HelloTriangleApp::WaitForGraphicsTimeline(uint64_t aValue)
+{
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &myVkGraphicsTimelineSemaphore;
+    waitInfo.pValues = &aValue;
+
+    if (vkWaitSemaphores(myVkDevice, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+        throw std::runtime_error("failed to wait for the graphics timeline!");
+}
+
+void HelloTriangleApp::StartShaderHotReload()
+{
+    using namespace HelloTriangleAppPrivate;
+
+    if (mySettings.myShaderSourcePath.empty())
+        return;
+
+    uint32_t enabledPipelines = ourScenePipelineBit;
+    if (myVkPostProcessPipeline)
+        enabledPipelines |= ourPostProcessPipelineBit;
+    if (myGpuCuller.IsEnabled())
+        enabledPipelines |= ourCullingPipelineBit;
+    if (mySettings.myIsSimulating)
+        enabledPipelines |= ourSimulationPipelineBit;
+
+    std::vector<std::string> watchedPaths;
+    for (const ShaderSource& source : ourShaderSources)
+    {
+        if (source.myPipelines & enabledPipelines)
+            watchedPaths.push_back(myShaderCompiler.GetSourcePath(source.myName));
+    }
+
+    // Runs on the watcher thread.
+    myShaderWatcher.Start(watchedPaths, [this](const std::vector<std::string>& someChangedPaths)
+    {
+        uint32_t changedPipelines = 0;
+        for (const std::string& path : someChangedPaths)
+        {
+            for (const ShaderSource& source : ourShaderSources)
+            {
+                if (path == myShaderCompiler.GetSourcePath(source.myName))
+                    changedPipelines |= source.myPipelines;
+            }
+        }
+
+        ReloadPipelines(changedPipelines);
+    });
+
+    std::cout << "Watching shader sources in " << mySettings.myShaderSourcePath << std::endl;
+}
+
+void HelloTriangleApp::ReloadPipelines(uint32_t somePipelines)
+{
+    using namespace HelloTriangleAppPrivate;
+
+    CPU_TRACE_ZONE("ReloadPipelines");
+
+    std::lock_guard<std::mutex> lock(myPipelineMutex);
+
+    // A pipeline whose shaders fail to compile stays in place; the others are still rebuilt.
+    if (somePipelines & ourScenePipelineBit)
+        RebuildPipeline(myVkDevice, myPendingGraphicsPipeline, [this]() { return CreateGraphicsPipeline(); });
+
+    if (somePipelines & ourPostProcessPipelineBit)
+        RebuildPipeline(myVkDevice, myPendingPostProcessPipeline, [this]() { return CreatePostProcessPipeline(); });
+
+    if (somePipelines & ourCullingPipelineBit)
+    {
+        RebuildPipeline(myVkDevice, myPendingCullingPipeline, [this]()
+        {
+            std::vector<uint32_t> spirv;
+            return myGpuCuller.CreatePipeline(myPipelineCache, GetShaderCode("cull.comp", spirv));
+        });
+    }
+
+    if (somePipelines & ourSimulationPipelineBit)
+    {
+        RebuildPipeline(myVkDevice, myPendingSimulationPipeline, [this]()
+        {
+            std::vector<uint32_t> spirv;
+            return myInstanceSimulation.CreatePipeline(myPipelineCache, GetShaderCode("simulate.comp", spirv));
+        });
+    }
+}
+
+void HelloTriangleApp::SwapInReloadedPipelines()
+{
+    if (mySettings.myShaderSourcePath.empty())
+        return;
+
+    uint64_t completedValue = 0;
+    vkGetSemaphoreCounterValue(myVkDevice, myVkGraphicsTimelineSemaphore, &completedValue);
+
+    auto retiredEnd = std::remove_if(myRetiredPipelines.begin(), myRetiredPipelines.end(), [this, completedValue](const RetiredPipeline& aRetiredPipeline)
+    {
+        if (aRetiredPipeline.myLastFrameValue > completedValue)
+            return false;
+
+        vkDestroyPipeline(myVkDevice, aRetiredPipeline.myVkPipeline, nullptr);
+        return true;
+    });
+    myRetiredPipelines.erase(retiredEnd, myRetiredPipelines.end());
+
+    // Never wait for a reload that is still compiling; it is picked up on a later frame.
+    std::unique_lock<std::mutex> lock(myPipelineMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+
+    // Frames submitted so far may still be using the current pipelines. A frame's graphics work waits for its
+    // simulation, so the graphics timeline also tells when the compute pipelines are no longer in use.
+    if (myPendingGraphicsPipeline)
+    {
+        myRetiredPipelines.push_back({ myVkGraphicsPipeline, mySubmittedFrameCount });
+        myVkGraphicsPipeline = myPendingGraphicsPipeline;
+        myPendingGraphicsPipeline = nullptr;
+        std::cout << "Swapped in reloaded graphics pipeline" << std::endl;
+    }
+
+    if (myPendingPostProcessPipeline)
+    {
+        myRetiredPipelines.push_back({ myVkPostProcessPipeline, mySubmittedFrameCount });
+        myVkPostProcessPipeline = myPendingPostProcessPipeline;
+        myPendingPostProcessPipeline = nullptr;
+        std::cout << "Swapped in reloaded post-process pipeline" << std::endl;
+    }
+
+    if (myPendingCullingPipeline)
+    {
+        myRetiredPipelines.push_back({ myGpuCuller.ReplacePipeline(myPendingCullingPipeline), mySubmittedFrameCount });
+        myPendingCullingPipeline = nullptr;
+        std::cout << "Swapped in reloaded culling pipeline" << std::endl;
+    }
+
+    if (myPendingSimulationPipeline)
+    {
+        myRetiredPipelines.push_back({ myInstanceSimulation.ReplacePipeline(myPendingSimulationPipeline), mySubmittedFrameCount });
+        myPendingSimulationPipeline = nullptr;
+        std::cout << "Swapped in reloaded simulation pipeline" << std::endl;
+    }
+}
+
+void HelloTriangleApp::CreateGpuProfiler()
+{
+    const PhysicalDeviceInfo& deviceInfo = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice);
+
+    QueueFamilyIndices indices = GetQueueFamilyIndices(myVkPhysicalDevice);
+    myGpuProfiler.Create(myVkDevice, deviceInfo.myProperties, deviceInfo.myQueueFamilies[indices.myGraphicsFamily.value()].timestampValidBits, mySettings.myFramesInFlightCount);
+}
+
+void HelloTriangleApp::RecordCommandBuffer(uint32_t aFrameIndex, uint32_t anImageIndex)
+{
+    CPU_TRACE_ZONE("RecordCommandBuffer");
+
+    FrameCommandBuffers& frameCommandBuffers = myFrameCommandBuffers[aFrameIndex];
+    VkCommandBuffer commandBuffer = frameCommandBuffers.myVkPrimaryCommandBuffer;
+
+    for (VkCommandPool& commandPool : frameCommandBuffers.myVkCommandPools)
+        vkResetCommandPool(myVkDevice, commandPool, 0);
+
+    // Camera updates are a single copy into the mapped ring; recording threads only see the offset.
+    HelloTriangleAppPrivate::FrameUniforms frameUniforms = {};
+    frameUniforms.myViewProjection = myViewProjection;
+    myFrameUniformOffset = myFrameUniforms.Push(frameUniforms);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording command buffer!");
+
+    myGpuProfiler.BeginFrame(commandBuffer, aFrameIndex);
+
+    if (myTextureStreamer.GetPendingCount() > 0)
+    {
+        const uint32_t streamingScope = myGpuProfiler.BeginScope(commandBuffer, "TextureStreaming");
+        myTextureStreamer.Record(commandBuffer, mySubmittedFrameCount + 1);
+        myGpuProfiler.EndScope(commandBuffer, streamingScope);
+
+        if (myTextureStreamer.GetPendingCount() == 0)
+        {
+            std::cout << "Textures resident after " << mySubmittedFrameCount + 1 << " frames, using "
+                << myTextureStreamer.GetAllocatedBytes() / 1024 << " of " << myTextureStreamer.GetMemoryBudget() / 1024 << " KiB" << std::endl;
+        }
+
+        // Every level has been copied to staging memory, so the source bytes are no longer read.
+        if (myTextureStreamer.IsResident(myTextureId))
+        {
+            myTextureSourceData.clear();
+            myTextureSourceData.shrink_to_fit();
+        }
+    }
+
+    // Read by the recording threads; it changes as finer levels arrive.
+    myTextureHandle = myTextureStreamer.GetSampledImageHandle(myTextureId);
+
+    if (myDrawSubmissionMode == DrawSubmissionMode::GpuCulled)
+    {
+        const uint32_t cullingScope = myGpuProfiler.BeginScope(commandBuffer, "Culling");
+        myGpuCuller.RecordCulling(commandBuffer, aFrameIndex, myViewProjection);
+        myGpuProfiler.EndScope(commandBuffer, cullingScope);
+    }
+
+    // The graph opens a profiler scope per pass and handles the layout transitions of the swap chain image.
+    myRenderGraph.SetImportedImage(myBackbuffer, myVkSwapChainImages[anImageIndex], myVkSwapChainImageViews[anImageIndex]);
+    myRenderGraph.Execute(commandBuffer, aFrameIndex, myGpuProfiler);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record command buffer!");
+}
+
+void HelloTriangleApp::RecordMainPass(const RenderPassContext& aContext)
+{
+    FrameCommandBuffers& frameCommandBuffers = myFrameCommandBuffers[aContext.myFrameIndex];
+
+    VkCommandBufferInheritanceRenderingInfoKHR inheritanceRenderingInfo = {};
+    inheritanceRenderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    inheritanceRenderingInfo.colorAttachmentCount = aContext.myColorFormatCount;
+    inheritanceRenderingInfo.pColorAttachmentFormats = aContext.myColorFormats;
+    inheritanceRenderingInfo.depthAttachmentFormat = aContext.myDepthFormat;
+    inheritanceRenderingInfo.rasterizationSamples = aContext.mySampleCount;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = myUsesDynamicRendering ? &inheritanceRenderingInfo : nullptr;
+    inheritanceInfo.renderPass = aContext.myVkRenderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = aContext.myVkFramebuffer;
+
+    // Small scenes are not worth waking up workers for, so each thread gets at least a minimum batch of draws.
+    // Indirect and GPU-culled draws are a handful of commands however many objects there are.
+    const uint32_t drawCount = static_cast<uint32_t>(myDrawCommands.size());
+    const bool isRecordedOnOneThread = myDrawSubmissionMode == DrawSubmissionMode::Indirect || myDrawSubmissionMode == DrawSubmissionMode::GpuCulled;
+    const uint32_t maxThreadCount = isRecordedOnOneThread ? 1u : static_cast<uint32_t>(frameCommandBuffers.myVkSecondaryCommandBuffers.size());
+    const uint32_t threadCount = std::clamp((drawCount + HelloTriangleAppPrivate::ourMinDrawsPerRecordingThread - 1) / HelloTriangleAppPrivate::ourMinDrawsPerRecordingThread, 1u, maxThreadCount);
+    const uint32_t drawsPerThread = (drawCount + threadCount - 1) / threadCount;
+
+    myJobSystem.ParallelFor(threadCount, [&](uint32_t aThreadIndex)
+    {
+        const uint32_t firstDraw = std::min(aThreadIndex * drawsPerThread, drawCount);
+        const uint32_t lastDraw = std::min(firstDraw + drawsPerThread, drawCount);
+        RecordDrawCommands(frameCommandBuffers.myVkSecondaryCommandBuffers[aThreadIndex], inheritanceInfo, aContext.myFrameIndex, firstDraw, lastDraw);
+    });
+
+    vkCmdExecuteCommands(aContext.myVkCommandBuffer, threadCount, frameCommandBuffers.myVkSecondaryCommandBuffers.data());
+}
+
+void HelloTriangleApp::RecordDrawCommands(VkCommandBuffer aCommandBuffer, const VkCommandBufferInheritanceInfo& anInheritanceInfo, uint32_t aFrameIndex, uint32_t aFirstDraw, uint32_t aLastDraw)
+{
+    CPU_TRACE_ZONE("RecordDrawCommands");
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &anInheritanceInfo;
+
+    if (vkBeginCommandBuffer(aCommandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+
+    vkCmdBindPipeline(aCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, myVkGraphicsPipeline);
+
+    VkViewport viewport = {};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(myVkSwapChainExtent.width);
+    viewport.height = static_cast<float>(myVkSwapChainExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(aCommandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.offset = { 0, 0 };
+    scissor.extent = myVkSwapChainExtent;
+    vkCmdSetScissor(aCommandBuffer, 0, 1, &scissor);
+
+    const GpuBuffer& instanceBuffer = myInstanceSimulation.HasScene() ? myInstanceSimulation.GetInstanceBuffer(aFrameIndex) : myInstanceBuffer;
+
+    VkBuffer vertexBuffers[] = { myVertexBuffer.GetVkBuffer(), instanceBuffer.GetVkBuffer() };
+    VkDeviceSize offsets[] = { 0, 0 };
+    vkCmdBindVertexBuffers(aCommandBuffer, 0, 2, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(aCommandBuffer, myIndexBuffer.GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+
+    // The bindless set is bound once per command buffer; draws only differ in the handles they push.
+    myBindlessDescriptors.Bind(aCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, myVkPipelineLayout);
+    myFrameUniforms.Bind(aCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, myVkPipelineLayout, 1, myFrameUniformOffset);
+
+    HelloTriangleAppPrivate::SceneConstants sceneConstants = {};
+    sceneConstants.myMaterialBufferHandle = myMaterialBufferHandle;
+    sceneConstants.myMaterialCount = static_cast<uint32_t>(HelloTriangleAppPrivate::ourMaterialColors.size());
+    sceneConstants.myTextureHandle = myTextureHandle;
+    sceneConstants.mySamplerHandle = myTextureStreamer.GetSamplerHandle();
+    vkCmdPushConstants(aCommandBuffer, myVkPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(sceneConstants), &sceneConstants);
+
+    if (myDrawSubmissionMode == DrawSubmissionMode::GpuCulled)
+    {
+        myGpuCuller.RecordDraw(aCommandBuffer, aFrameIndex);
+    }
+    else if (myDrawSubmissionMode == DrawSubmissionMode::Indirect)
+    {
+        const uint32_t stride = sizeof(DrawCommand);
+
+        if (myVkEnabledFeatures.multiDrawIndirect)
+        {
+            const VkPhysicalDeviceProperties& properties = myPhysicalDeviceSelector.GetDeviceInfo(myVkPhysicalDevice).myProperties;
+
+            for (uint32_t firstDraw = aFirstDraw; firstDraw < aLastDraw; firstDraw += properties.limits.maxDrawIndirectCount)
+            {
+                const uint32_t drawCount = std::min(aLastDraw - firstDraw, properties.limits.maxDrawIndirectCount);
+                vkCmdDrawIndexedIndirect(aCommandBuffer, myIndirectBuffer.GetVkBuffer(), static_cast<VkDeviceSize>(firstDraw) * stride, drawCount, stride);
+            }
+        }
+        else
+        {
+            for (uint32_t i = aFirstDraw; i < aLastDraw; i++)
+                vkCmdDrawIndexedIndirect(aCommandBuffer, myIndirectBuffer.GetVkBuffer(), static_cast<VkDeviceSize>(i) * stride, 1, stride);
+        }
+    }
+    else
+    {
+        for (uint32_t i = aFirstDraw; i < aLastDraw; i++)
+        {
+            const DrawCommand& drawCommand = myDrawCommands[i];
+            vkCmdDrawIndexed(aCommandBuffer, drawCommand.myIndexCount, drawCommand.myInstanceCount, drawCommand.myFirstIndex, drawCommand.myVertexOffset, drawCommand.myFirstInstance);
+        }
+    }
+
+    if (vkEndCommandBuffer(aCommandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record secondary command buffer!");
+}
+
+void HelloTriangleApp::RecordPostProcessPass(const RenderPassContext& aContext, RenderGraphResource aSource, uint32_t aMode)
+{
+    vkCmdBindPipeline(aContext.myVkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, myVkPostProcessPipeline);
+
+    VkViewport viewport = {};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(aContext.myExtent.width);
+    viewport.height = static_cast<float>(aContext.myExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(aContext.myVkCommandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.offset = { 0, 0 };
+    scissor.extent = aContext.myExtent;
+    vkCmdSetScissor(aContext.myVkCommandBuffer, 0, 1, &scissor);
+
+    myBindlessDescriptors.Bind(aContext.myVkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, myVkPipelineLayout);
+
+    const uint32_t postConstants[] = { myRenderGraph.GetSampledImageHandle(aSource), aMode };
+    vkCmdPushConstants(aContext.myVkCommandBuffer, myVkPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(postConstants), postConstants);
+
+    vkCmdDraw(aContext.myVkCommandBuffer, 3, 1, 0, 0);
 }
 
 void HelloTriangleApp::DrawFrame()
 {
-    vkWaitForFences(myVkDevice, 1, &myVkInFlightFences[myCurrentFrameIndex], VK_TRUE, UINT64_MAX);
+    CPU_TRACE_ZONE("DrawFrame");
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(myVkDevice, myVkSwapChain, UINT64_MAX, myVkImageAvailableSemaphores[myCurrentFrameIndex], nullptr, &imageIndex);
+    // Frame n signals value n on the graphics timeline, and shares its slot with frame n - myFramesInFlightCount.
+    const uint64_t frameValue = mySubmittedFrameCount + 1;
+    const uint32_t frameIndex = static_cast<uint32_t>(mySubmittedFrameCount % mySettings.myFramesInFlightCount);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    if (frameValue > mySettings.myFramesInFlightCount)
     {
+        CPU_TRACE_ZONE("WaitForFrameSlot");
+        WaitForGraphicsTimeline(frameValue - mySettings.myFramesInFlightCount);
+        myBindlessDescriptors.Update(frameValue - mySettings.myFramesInFlightCount);
+    }
+
+    myFrameUniforms.BeginFrame(frameIndex);
+    myTextureStreamer.BeginFrame(frameIndex, frameValue > mySettings.myFramesInFlightCount ? frameValue - mySettings.myFramesInFlightCount : 0);
+
+    SwapInReloadedPipelines();
+    myStagingRing.Update();
+
+    if (!mySettings.myIsHeadless && myRequestedPresentPolicy != myPresentPolicy)
+    {
+        myPresentPolicy = myRequestedPresentPolicy;
         RecreateSwapChain();
-        return;
     }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+
+    uint32_t imageIndex;
+    if (mySettings.myIsHeadless)
     {
-        throw std::runtime_error("failed to acquire swap chain image!");
+        imageIndex = myOffscreenImageIndex;
+        myOffscreenImageIndex = (myOffscreenImageIndex + 1) % static_cast<uint32_t>(myVkSwapChainImages.size());
     }
+    else
+    {
+        CPU_TRACE_ZONE("AcquireNextImage");
+        VkResult result = vkAcquireNextImageKHR(myVkDevice, myVkSwapChain, UINT64_MAX, myVkImageAvailableSemaphores[frameIndex], nullptr, &imageIndex);
 
-    if (myVkImagesInFlight[imageIndex])
-        vkWaitForFences(myVkDevice, 1, &myVkImagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            RecreateSwapChain();
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
+    }
+
+    // The image may still be rendered to by a frame from another slot.
+    if (myImageTimelineValues[imageIndex] > 0)
+    {
+        CPU_TRACE_ZONE("WaitForImageInFlight");
+        WaitForGraphicsTimeline(myImageTimelineValues[imageIndex]);
+    }
+
+    myImageTimelineValues[imageIndex] = frameValue;
+
+    // Compute work is submitted as early as possible so that it overlaps the graphics work of the previous frames.
+    // It signals the compute timeline with this frame's value, which the graphics submission waits on.
+    const bool isComputeSubmitted = myInstanceSimulation.HasScene();
+    if (isComputeSubmitted)
+    {
+        CPU_TRACE_ZONE("RecordCompute");
+
+        VkCommandBuffer computeCommandBuffer = myComputeScheduler.BeginFrame(frameIndex);
+        myInstanceSimulation.Record(computeCommandBuffer, frameIndex, std::chrono::duration<float>(std::chrono::steady_clock::now() - myStartTime).count());
+        myComputeScheduler.Submit(frameIndex, frameValue);
+    }
+
+    const std::chrono::steady_clock::time_point recordStart = std::chrono::steady_clock::now();
+    RecordCommandBuffer(frameIndex, imageIndex);
+    myLastRecordTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+
+    VkSemaphore waitSemaphores[2];
+    uint64_t waitValues[2];
+    VkPipelineStageFlags waitStages[2];
+    uint32_t waitSemaphoreCount = 0;
+
+    if (!mySettings.myIsHeadless)
+    {
+        waitSemaphores[waitSemaphoreCount] = myVkImageAvailableSemaphores[frameIndex];
+        waitValues[waitSemaphoreCount] = 0;
+        waitStages[waitSemaphoreCount++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    }
 
-    myVkImagesInFlight[imageIndex] = myVkInFlightFences[myCurrentFrameIndex];
+    // Simulated instances are read as vertex attributes and by the culling pass.
+    if (isComputeSubmitted)
+    {
+        waitSemaphores[waitSemaphoreCount] = myComputeScheduler.GetVkTimelineSemaphore();
+        waitValues[waitSemaphoreCount] = frameValue;
+        waitStages[waitSemaphoreCount++] = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+
+    // Binary semaphores ignore their value.
+    VkSemaphore signalSemaphores[] = { myVkGraphicsTimelineSemaphore, myVkRenderFinishedSemaphores[frameIndex] };
+    const uint64_t signalValues[] = { frameValue, 0 };
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = mySettings.myIsHeadless ? 1 : 2;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    VkSemaphore waitSemaphores[] = { myVkImageAvailableSemaphores[myCurrentFrameIndex] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = waitSemaphoreCount;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
-
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &myVkCommandBuffers[imageIndex];
-
-    VkSemaphore signalSemaphores[] = { myVkRenderFinishedSemaphores[myCurrentFrameIndex] };
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pCommandBuffers = &myFrameCommandBuffers[frameIndex].myVkPrimaryCommandBuffer;
+    submitInfo.signalSemaphoreCount = mySettings.myIsHeadless ? 1 : 2;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    vkResetFences(myVkDevice, 1, &myVkInFlightFences[myCurrentFrameIndex]);
+    {
+        CPU_TRACE_ZONE("QueueSubmit");
+        if (vkQueueSubmit(myVkGraphicsQueue, 1, &submitInfo, nullptr) != VK_SUCCESS)
+            throw std::runtime_error("failed to submit draw command buffer!");
+    }
+
+    mySubmittedFrameCount = frameValue;
 
-    if (vkQueueSubmit(myVkGraphicsQueue, 1, &submitInfo, myVkInFlightFences[myCurrentFrameIndex]) != VK_SUCCESS)
-        throw std::runtime_error("failed to submit draw command buffer!");
+    if (mySettings.myIsHeadless)
+        return;
 
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &myVkRenderFinishedSemaphores[frameIndex];
 
     VkSwapchainKHR swapChains[] = { myVkSwapChain };
     presentInfo.swapchainCount = 1;
@@ -734,7 +2200,11 @@ void HelloTriangleApp::DrawFrame()
 
     presentInfo.pImageIndices = &imageIndex;
 
-    result = vkQueuePresentKHR(myVkPresentQueue, &presentInfo);
+    VkResult result;
+    {
+        CPU_TRACE_ZONE("QueuePresent");
+        result = vkQueuePresentKHR(myVkPresentQueue, &presentInfo);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || myIsFramebufferResized)
     {
@@ -745,16 +2215,45 @@ void HelloTriangleApp::DrawFrame()
     {
         throw std::runtime_error("failed to present swap chain image!");
     }
+}
+
+void HelloTriangleApp::ReportTimeToFirstFrame()
+{
+    // Counted from construction until the GPU finished the first frame, so it covers window and device bring-up.
+    WaitForGraphicsTimeline(1);
+
+    const double timeToFirstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - myStartTime).count();
+    std::cout << std::fixed << std::setprecision(3)
+        << "Time to first frame: " << timeToFirstFrameMs << " ms (Vulkan initialization " << myInitializationTimeMs << " ms)"
+        << std::defaultfloat << std::endl;
+}
 
-    myCurrentFrameIndex = (myCurrentFrameIndex + 1) % HelloTriangleAppPrivate::ourMaxFramesInFlight;
+AssetView HelloTriangleApp::GetShaderCode(const std::string& aSourceName, std::vector<uint32_t>& someSpirv)
+{
+    if (mySettings.myShaderSourcePath.empty())
+        return myShaderArchive.Get(aSourceName + ".spv");
+
+    someSpirv = myShaderCompiler.Compile(aSourceName);
+
+    AssetView shaderCode;
+    shaderCode.myData = someSpirv.data();
+    shaderCode.mySize = someSpirv.size() * sizeof(uint32_t);
+    return shaderCode;
 }
 
-VkShaderModule HelloTriangleApp::CreateShaderModule(const std::vector<char>& aShaderCode)
+VkShaderModule HelloTriangleApp::LoadShaderModule(const std::string& aSourceName)
 {
+    std::vector<uint32_t> spirv;
+    return CreateShaderModule(GetShaderCode(aSourceName, spirv));
+}
+
+VkShaderModule HelloTriangleApp::CreateShaderModule(const AssetView& aShaderCode)
+{
+    // Archive entries are aligned for SPIR-V words, so the driver reads the code straight from the mapping.
     VkShaderModuleCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = aShaderCode.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(aShaderCode.data());
+    createInfo.codeSize = aShaderCode.mySize;
+    createInfo.pCode = static_cast<const uint32_t*>(aShaderCode.myData);
 
     VkShaderModule shaderModule;
     if (vkCreateShaderModule(myVkDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
@@ -776,15 +2275,31 @@ VkSurfaceFormatKHR HelloTriangleApp::ChooseSwapSurfaceFormat(const std::vector<V
 
 VkPresentModeKHR HelloTriangleApp::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& someAvailablePresentModes)
 {
-    for (const VkPresentModeKHR& availablePresentMode : someAvailablePresentModes)
+    for (VkPresentModeKHR preferredPresentMode : HelloTriangleAppPrivate::GetPreferredPresentModes(myPresentPolicy))
     {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-            return availablePresentMode;
+        if (std::find(someAvailablePresentModes.begin(), someAvailablePresentModes.end(), preferredPresentMode) != someAvailablePresentModes.end())
+            return preferredPresentMode;
     }
 
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+uint32_t HelloTriangleApp::ChooseSwapImageCount(VkPresentModeKHR aPresentMode, const VkSurfaceCapabilitiesKHR& aCapabilities)
+{
+    // Mailbox needs a spare image to replace while one is displayed and another rendered to. FIFO gets one more than
+    // the minimum so rendering does not stall on vblank; immediate and relaxed FIFO keep the minimum for latency and memory.
+    uint32_t imageCount = aCapabilities.minImageCount;
+    if (aPresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+        imageCount = std::max(aCapabilities.minImageCount, 3u);
+    else if (aPresentMode == VK_PRESENT_MODE_FIFO_KHR)
+        imageCount = aCapabilities.minImageCount + 1;
+
+    if (aCapabilities.maxImageCount > 0 && imageCount > aCapabilities.maxImageCount)
+        imageCount = aCapabilities.maxImageCount;
+
+    return imageCount;
+}
+
 VkExtent2D HelloTriangleApp::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& aCapabilities)
 {
     if (aCapabilities.currentExtent.width != UINT32_MAX)
@@ -841,14 +2356,30 @@ bool HelloTriangleApp::IsDeviceSuitable(VkPhysicalDevice device)
 
     bool extensionsSupported = HasDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported)
+    bool swapChainAdequate = mySettings.myIsHeadless;
+    if (extensionsSupported && !mySettings.myIsHeadless)
     {
         SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
         swapChainAdequate = !swapChainSupport.myFormats.empty() && !swapChainSupport.myPresentModes.empty();
     }
 
-    return indices.IsComplete() && extensionsSupported && swapChainAdequate;
+    return indices.IsComplete() && extensionsSupported && swapChainAdequate && HasRequiredFeatures(device);
+}
+
+bool HelloTriangleApp::HasRequiredFeatures(VkPhysicalDevice aDevice)
+{
+    const PhysicalDeviceInfo& deviceInfo = myPhysicalDeviceSelector.GetDeviceInfo(aDevice);
+
+    // Vulkan 1.2 features are left unset on devices that do not implement 1.2.
+    if (deviceInfo.myProperties.apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    const VkPhysicalDeviceVulkan12Features& features = deviceInfo.myVulkan12Features;
+    const bool hasBindlessFeatures = deviceInfo.myFeatures.shaderStorageBufferArrayDynamicIndexing && deviceInfo.myFeatures.shaderSampledImageArrayDynamicIndexing
+        && features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound && features.descriptorBindingUpdateUnusedWhilePending
+        && features.descriptorBindingStorageBufferUpdateAfterBind && features.descriptorBindingSampledImageUpdateAfterBind && features.shaderSampledImageArrayNonUniformIndexing;
+
+    return features.timelineSemaphore && hasBindlessFeatures;
 }
 
 bool HelloTriangleApp::HasDeviceExtensionSupport(VkPhysicalDevice aDevice)
@@ -859,7 +2390,8 @@ bool HelloTriangleApp::HasDeviceExtensionSupport(VkPhysicalDevice aDevice)
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(aDevice, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(HelloTriangleAppPrivate::ourDeviceExtensions.begin(), HelloTriangleAppPrivate::ourDeviceExtensions.end());
+    std::vector<const char*> deviceExtensions = GetRequiredDeviceExtensions();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
     for (const VkExtensionProperties& extension : availableExtensions)
         requiredExtensions.erase(extension.extensionName);
@@ -871,11 +2403,7 @@ QueueFamilyIndices HelloTriangleApp::GetQueueFamilyIndices(VkPhysicalDevice aDev
 {
     QueueFamilyIndices indices;
 
-    uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(aDevice, &queueFamilyCount, nullptr);
-
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(aDevice, &queueFamilyCount, queueFamilies.data());
+    const std::vector<VkQueueFamilyProperties>& queueFamilies = myPhysicalDeviceSelector.GetDeviceInfo(aDevice).myQueueFamilies;
 
     int i = 0;
     for (const VkQueueFamilyProperties& queueFamily : queueFamilies)
@@ -883,8 +2411,12 @@ QueueFamilyIndices HelloTriangleApp::GetQueueFamilyIndices(VkPhysicalDevice aDev
         if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
             indices.myGraphicsFamily = i;
 
+        // Headless frames are never presented, so the graphics queue doubles as the present queue.
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(aDevice, i, myVkSurface, &presentSupport);
+        if (mySettings.myIsHeadless)
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        else
+            vkGetPhysicalDeviceSurfaceSupportKHR(aDevice, i, myVkSurface, &presentSupport);
 
         if (presentSupport)
             indices.myPresentFamily = i;
@@ -895,16 +2427,54 @@ QueueFamilyIndices HelloTriangleApp::GetQueueFamilyIndices(VkPhysicalDevice aDev
         i++;
     }
 
+    // Prefer a transfer-only family (usually a DMA engine), then one without graphics, so uploads overlap rendering.
+    int bestTransferScore = -1;
+    for (uint32_t familyIndex = 0; familyIndex < queueFamilies.size(); familyIndex++)
+    {
+        const VkQueueFlags queueFlags = queueFamilies[familyIndex].queueFlags;
+        if (!(queueFlags & VK_QUEUE_TRANSFER_BIT) || (queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            continue;
+
+        const int transferScore = (queueFlags & VK_QUEUE_COMPUTE_BIT) ? 0 : 1;
+        if (transferScore > bestTransferScore)
+        {
+            bestTransferScore = transferScore;
+            indices.myTransferFamily = familyIndex;
+        }
+    }
+
+    if (!indices.myTransferFamily.has_value())
+        indices.myTransferFamily = indices.myGraphicsFamily;
+
+    // An async compute family runs compute work alongside the graphics queue instead of between its submissions.
+    for (uint32_t familyIndex = 0; familyIndex < queueFamilies.size(); familyIndex++)
+    {
+        const VkQueueFlags queueFlags = queueFamilies[familyIndex].queueFlags;
+        if ((queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFlags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            indices.myComputeFamily = familyIndex;
+            break;
+        }
+    }
+
+    if (!indices.myComputeFamily.has_value())
+        indices.myComputeFamily = indices.myGraphicsFamily;
+
     return indices;
 }
 
 std::vector<const char*> HelloTriangleApp::GetRequiredExtensions()
 {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
+
+    if (!mySettings.myIsHeadless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers)
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -912,6 +2482,14 @@ std::vector<const char*> HelloTriangleApp::GetRequiredExtensions()
     return extensions;
 }
 
+std::vector<const char*> HelloTriangleApp::GetRequiredDeviceExtensions()
+{
+    if (mySettings.myIsHeadless)
+        return {};
+
+    return HelloTriangleAppPrivate::ourDeviceExtensions;
+}
+
 bool HelloTriangleApp::HasValidationLayerSupport()
 {
     uint32_t layerCount;
@@ -939,21 +2517,3 @@ bool HelloTriangleApp::HasValidationLayerSupport()
 
     return true;
 }
-
-std::vector<char> HelloTriangleApp::ReadFile(const std::string& aPath)
-{
-    std::ifstream file(aPath, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open())
-        throw std::runtime_error("failed to open file!");
-
-    unsigned int fileSize = static_cast<unsigned int>(file.tellg());
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-
-    file.close();
-
-    return buffer;
-}
@@ -4,81 +4,217 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "ApplicationSettings.h"
+#include "AssetArchive.h"
+#include "BindlessDescriptors.h"
+#include "ComputeScheduler.h"
+#include "DeviceMemoryAllocator.h"
+#include "DrawCommand.h"
+#include "FileWatcher.h"
+#include "FrameCommandBuffers.h"
+#include "GpuBuffer.h"
+#include "GpuCuller.h"
+#include "GpuProfiler.h"
+#include "InstanceSimulation.h"
+#include "JobSystem.h"
+#include "PhysicalDeviceSelector.h"
+#include "PipelineCache.h"
+#include "RenderGraph.h"
+#include "ShaderCompiler.h"
+#include "StagingRing.h"
+#include "TextureStreamer.h"
+#include "UniformRing.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <mutex>
 #include <string>
 #include <vector>
 
+class FrameStatistics;
 struct SwapChainSupportDetails;
 struct QueueFamilyIndices;
 
 class HelloTriangleApp
 {
 public:
-    HelloTriangleApp();
+    HelloTriangleApp(const ApplicationSettings& aSettings);
 
     void Run();
 
 private:
     void InitializeWindow();
     static void FramebufferResizeCallback(GLFWwindow* aWindow, int aWidth, int aHeight);
+    static void KeyCallback(GLFWwindow* aWindow, int aKey, int aScancode, int anAction, int someModifiers);
     void InitializeVulkan();
     void MainLoop();
+    // Leaves the device idle and the GPU profiler holding the timings of the measured frames only.
+    bool RunFrames(uint32_t aFrameCount, FrameStatistics& aFrameStatistics, FrameStatistics& aRecordStatistics);
+    void RunDrawBenchmark();
+    void RunMsaaBenchmark();
     void CleanupSwapChain();
+    void CleanupGraphicsPipeline();
     void Cleanup();
     void RecreateSwapChain();
+    void RecreateRenderTargets(VkSampleCountFlagBits aSampleCount);
     void CreateInstance();
     void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& aCreateInfo);
     void SetupDebugMessenger();
     void CreateSurface();
     void PickPhysicalDevice();
     void CreateLogicalDevice();
+    void CreateMemoryAllocator();
+    void CreatePipelineCache();
     void CreateSwapChain();
+    void CreateOffscreenImages();
     void CreateImageViews();
+    VkFormat ChooseDepthFormat() const;
+    VkSampleCountFlagBits ChooseSampleCount(uint32_t aRequestedCount) const;
     void CreateRenderPass();
-    void CreateGraphicsPipeline();
-    void CreateFramebuffers();
-    void CreateCommandPool();
+    void CreateBindlessDescriptors();
+    void CreateFrameUniforms();
+    void CreateShaderCompiler();
+    void CreatePipelineLayout();
+    VkPipeline CreateGraphicsPipeline();
+    VkPipeline CreatePostProcessPipeline();
+    // Depth testing is enabled when aDepthFormat is defined.
+    VkPipeline CreatePipeline(const std::string& aVertexShader, const std::string& aFragmentShader, const VkPipelineVertexInputStateCreateInfo& aVertexInputInfo, VkCullModeFlags aCullMode,
+        VkRenderPass aRenderPass, VkSampleCountFlagBits aSampleCount, VkFormat aDepthFormat, const std::string& aName);
+    void CreateGpuCuller();
+    void CreateRenderGraph();
+    void CreateCommandPools();
     void CreateCommandBuffers();
+    void CreateStagingRing();
+    void CreateComputeScheduler();
+    void CreateInstanceSimulation();
+    void CreateMaterials();
+    // Reads the texture file or generates the checkerboard into myTextureSourceData; the result points into it.
+    TextureData LoadTexture();
+    void CreateTextures(const TextureData& aTexture);
+    void CreateGeometryBuffers();
+    const char* GetMissingFeature(DrawSubmissionMode aMode) const;
+    void CreateScene(uint32_t anObjectCount, DrawSubmissionMode aMode);
+    void DestroyScene();
     void CreateSyncObjects();
+    void WaitForGraphicsTimeline(uint64_t aValue);
+    void StartShaderHotReload();
+    void ReloadPipelines(uint32_t somePipelines);
+    void SwapInReloadedPipelines();
+    void CreateGpuProfiler();
+    void RecordCommandBuffer(uint32_t aFrameIndex, uint32_t anImageIndex);
+    void RecordMainPass(const RenderPassContext& aContext);
+    void RecordDrawCommands(VkCommandBuffer aCommandBuffer, const VkCommandBufferInheritanceInfo& anInheritanceInfo, uint32_t aFrameIndex, uint32_t aFirstDraw, uint32_t aLastDraw);
+    void RecordPostProcessPass(const RenderPassContext& aContext, RenderGraphResource aSource, uint32_t aMode);
     void DrawFrame();
-    VkShaderModule CreateShaderModule(const std::vector<char>& aShaderCode);
+    void ReportTimeToFirstFrame();
+    // Compiled SPIR-V is stored in someSpirv; archived SPIR-V is returned straight from the mapping.
+    AssetView GetShaderCode(const std::string& aSourceName, std::vector<uint32_t>& someSpirv);
+    VkShaderModule LoadShaderModule(const std::string& aSourceName);
+    VkShaderModule CreateShaderModule(const AssetView& aShaderCode);
     VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& someAvailableFormats);
     VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& someAvailablePresentModes);
+    uint32_t ChooseSwapImageCount(VkPresentModeKHR aPresentMode, const VkSurfaceCapabilitiesKHR& aCapabilities);
     VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& aCapabilities);
     SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice aDevice);
-    static std::vector<char> ReadFile(const std::string& aFilename);
 
     bool IsDeviceSuitable(VkPhysicalDevice aDevice);
     bool HasDeviceExtensionSupport(VkPhysicalDevice aDevice);
+    bool HasRequiredFeatures(VkPhysicalDevice aDevice);
     bool HasValidationLayerSupport();
 
     QueueFamilyIndices GetQueueFamilyIndices(VkPhysicalDevice aDevice);
     std::vector<const char*> GetRequiredExtensions();
+    std::vector<const char*> GetRequiredDeviceExtensions();
 
 private:
-    std::string myResourcesPath;
+    struct RetiredPipeline
+    {
+        VkPipeline myVkPipeline;
+        uint64_t myLastFrameValue;
+    };
+
+    ApplicationSettings mySettings;
+    AssetArchive myShaderArchive;
+    ShaderCompiler myShaderCompiler;
+    FileWatcher myShaderWatcher;
     GLFWwindow* myGLFWWindow;
     VkInstance myVkInstance;
     VkDebugUtilsMessengerEXT myVkDebugMessenger;
     VkSurfaceKHR myVkSurface;
     VkPhysicalDevice myVkPhysicalDevice;
+    PhysicalDeviceSelector myPhysicalDeviceSelector;
     VkDevice myVkDevice;
+    VkPhysicalDeviceFeatures myVkEnabledFeatures;
+    VkPhysicalDeviceVulkan12Features myVkEnabledVulkan12Features;
     VkQueue myVkGraphicsQueue;
     VkQueue myVkPresentQueue;
+    VkQueue myVkTransferQueue;
+    VkQueue myVkComputeQueue;
     VkSwapchainKHR myVkSwapChain;
     VkFormat myVkSwapChainImageFormat;
     VkExtent2D myVkSwapChainExtent;
+    VkPresentModeKHR myVkPresentMode;
+    // Compatible with the main pass and the post-processing passes of the render graph respectively; pipelines are
+    // built against them. Null with dynamic rendering, where pipelines only name the attachment formats.
     VkRenderPass myVkRenderPass;
+    VkRenderPass myVkPostProcessRenderPass;
+    // Of the main pass. The depth format is undefined without depth testing.
+    VkSampleCountFlagBits mySampleCount;
+    VkFormat myDepthFormat;
     VkPipelineLayout myVkPipelineLayout;
     VkPipeline myVkGraphicsPipeline;
-    VkCommandPool myVkCommandPool;
+    VkPipeline myPendingGraphicsPipeline;
+    VkPipeline myVkPostProcessPipeline;
+    VkPipeline myPendingPostProcessPipeline;
+    VkPipeline myPendingCullingPipeline;
+    VkPipeline myPendingSimulationPipeline;
+    std::vector<RetiredPipeline> myRetiredPipelines;
+    // Guards the pending pipelines, and the render passes while a reload builds against them.
+    std::mutex myPipelineMutex;
+    DeviceMemoryAllocator myMemoryAllocator;
+    PipelineCache myPipelineCache;
+    BindlessDescriptors myBindlessDescriptors;
+    UniformRing myFrameUniforms;
+    GpuProfiler myGpuProfiler;
+    TextureStreamer myTextureStreamer;
+    GpuCuller myGpuCuller;
+    StagingRing myStagingRing;
+    ComputeScheduler myComputeScheduler;
+    InstanceSimulation myInstanceSimulation;
+    GpuBuffer myVertexBuffer;
+    GpuBuffer myIndexBuffer;
+    GpuBuffer myInstanceBuffer;
+    GpuBuffer myIndirectBuffer;
+    GpuBuffer myMaterialBuffer;
+    uint32_t myMaterialBufferHandle;
+    uint32_t myFrameUniformOffset;
+    // Source bytes of the streamed texture, released once it is resident.
+    std::vector<uint8_t> myTextureSourceData;
+    TextureId myTextureId;
+    uint32_t myTextureHandle;
     std::vector<VkImage> myVkSwapChainImages;
+    std::vector<MemoryAllocation> myOffscreenImageAllocations;
     std::vector<VkImageView> myVkSwapChainImageViews;
-    std::vector<VkFramebuffer> myVkSwapChainFramebuffers;
-    std::vector<VkCommandBuffer> myVkCommandBuffers;
+    RenderGraph myRenderGraph;
+    RenderGraphResource myBackbuffer;
+    std::vector<FrameCommandBuffers> myFrameCommandBuffers;
+    std::vector<DrawCommand> myDrawCommands;
+    DrawSubmissionMode myDrawSubmissionMode;
+    glm::mat4 myViewProjection;
+    JobSystem myJobSystem;
     std::vector<VkSemaphore> myVkImageAvailableSemaphores;
     std::vector<VkSemaphore> myVkRenderFinishedSemaphores;
-    std::vector<VkFence> myVkInFlightFences;
-    std::vector<VkFence> myVkImagesInFlight;
-    int myCurrentFrameIndex;
+    VkSemaphore myVkGraphicsTimelineSemaphore;
+    std::vector<uint64_t> myImageTimelineValues;
+    uint64_t mySubmittedFrameCount;
+    uint32_t myOffscreenImageIndex;
+    double myLastRecordTimeMs;
+    std::chrono::steady_clock::time_point myStartTime;
+    double myInitializationTimeMs;
+    PresentPolicy myPresentPolicy;
+    PresentPolicy myRequestedPresentPolicy;
+    bool myUsesDynamicRendering;
     bool myIsFramebufferResized;
+    bool myIsTraceDumpRequested;
 };
@@ -0,0 +1,218 @@
+#include "InstanceSimulation.h"
+#include "AssetArchive.h"
+#include "PipelineCache.h"
+#include "Vertex.h"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace InstanceSimulationPrivate
+{
+    static constexpr uint32_t ourWorkgroupSize = 64;
+
+    // Matches the push constant block of simulate.comp.
+    struct SimulationConstants
+    {
+        uint32_t myObjectCount;
+        uint32_t myGridSize;
+        float myCellSize;
+        float myTime;
+    };
+}
+
+InstanceSimulation::InstanceSimulation()
+    : myVkDevice(nullptr)
+    , myVkDescriptorSetLayout(nullptr)
+    , myVkDescriptorPool(nullptr)
+    , myVkPipelineLayout(nullptr)
+    , myVkPipeline(nullptr)
+    , myObjectCount(0)
+    , myGridSize(0)
+    , myCellSize(0.0f)
+{
+}
+
+void InstanceSimulation::Create(VkDevice aDevice, PipelineCache& aPipelineCache, const AssetView& aShaderCode, uint32_t aFrameCount)
+{
+    myVkDevice = aDevice;
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(myVkDevice, &layoutInfo, nullptr, &myVkDescriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create simulation descriptor set layout!");
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = aFrameCount;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = aFrameCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(myVkDevice, &poolInfo, nullptr, &myVkDescriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create simulation descriptor pool!");
+
+    myFrames.resize(aFrameCount);
+
+    std::vector<VkDescriptorSetLayout> setLayouts(aFrameCount, myVkDescriptorSetLayout);
+    std::vector<VkDescriptorSet> descriptorSets(aFrameCount);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = myVkDescriptorPool;
+    allocInfo.descriptorSetCount = aFrameCount;
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(myVkDevice, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate simulation descriptor sets!");
+
+    for (uint32_t i = 0; i < aFrameCount; i++)
+        myFrames[i].myVkDescriptorSet = descriptorSets[i];
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(InstanceSimulationPrivate::SimulationConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &myVkDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(myVkDevice, &pipelineLayoutInfo, nullptr, &myVkPipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create simulation pipeline layout!");
+
+    myVkPipeline = CreatePipeline(aPipelineCache, aShaderCode);
+}
+
+VkPipeline InstanceSimulation::CreatePipeline(PipelineCache& aPipelineCache, const AssetView& aShaderCode) const
+{
+    VkShaderModuleCreateInfo shaderModuleInfo = {};
+    shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleInfo.codeSize = aShaderCode.mySize;
+    shaderModuleInfo.pCode = static_cast<const uint32_t*>(aShaderCode.myData);
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(myVkDevice, &shaderModuleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        throw std::runtime_error("failed to create shader module!");
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = myVkPipelineLayout;
+
+    PipelineCreationFeedback feedback;
+    pipelineInfo.pNext = aPipelineCache.ChainCreationFeedback(feedback, pipelineInfo.pNext);
+
+    const std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline = nullptr;
+    const VkResult result = vkCreateComputePipelines(myVkDevice, aPipelineCache.GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(myVkDevice, shaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create simulation pipeline!");
+
+    aPipelineCache.RecordCreationTime("Simulation", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - creationStart).count(), feedback);
+
+    return pipeline;
+}
+
+VkPipeline InstanceSimulation::ReplacePipeline(VkPipeline aPipeline)
+{
+    VkPipeline previousPipeline = myVkPipeline;
+    myVkPipeline = aPipeline;
+    return previousPipeline;
+}
+
+void InstanceSimulation::Destroy()
+{
+    DestroyScene();
+    myFrames.clear();
+
+    if (myVkPipeline)
+        vkDestroyPipeline(myVkDevice, myVkPipeline, nullptr);
+
+    if (myVkPipelineLayout)
+        vkDestroyPipelineLayout(myVkDevice, myVkPipelineLayout, nullptr);
+
+    if (myVkDescriptorPool)
+        vkDestroyDescriptorPool(myVkDevice, myVkDescriptorPool, nullptr);
+
+    if (myVkDescriptorSetLayout)
+        vkDestroyDescriptorSetLayout(myVkDevice, myVkDescriptorSetLayout, nullptr);
+
+    myVkPipeline = nullptr;
+    myVkPipelineLayout = nullptr;
+    myVkDescriptorPool = nullptr;
+    myVkDescriptorSetLayout = nullptr;
+}
+
+void InstanceSimulation::SetScene(DeviceMemoryAllocator& anAllocator, uint32_t anObjectCount, uint32_t aGridSize, float aCellSize, const std::vector<uint32_t>& someQueueFamilyIndices)
+{
+    DestroyScene();
+
+    myObjectCount = anObjectCount;
+    myGridSize = aGridSize;
+    myCellSize = aCellSize;
+
+    // The shader writes instances as a tightly packed float array.
+    static_assert(sizeof(InstanceData) == 3 * sizeof(float), "InstanceData must be tightly packed");
+
+    const VkDeviceSize instanceBufferSize = sizeof(InstanceData) * static_cast<VkDeviceSize>(anObjectCount);
+
+    for (FrameResources& frame : myFrames)
+    {
+        frame.myInstanceBuffer.Create(anAllocator, instanceBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, someQueueFamilyIndices);
+
+        VkDescriptorBufferInfo bufferInfo = { frame.myInstanceBuffer.GetVkBuffer(), 0, VK_WHOLE_SIZE };
+
+        VkWriteDescriptorSet descriptorWrite = {};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = frame.myVkDescriptorSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.pBufferInfo = &bufferInfo;
+
+        vkUpdateDescriptorSets(myVkDevice, 1, &descriptorWrite, 0, nullptr);
+    }
+}
+
+void InstanceSimulation::DestroyScene()
+{
+    for (FrameResources& frame : myFrames)
+        frame.myInstanceBuffer.Destroy();
+
+    myObjectCount = 0;
+}
+
+void InstanceSimulation::Record(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex, float aTime)
+{
+    InstanceSimulationPrivate::SimulationConstants constants = {};
+    constants.myObjectCount = myObjectCount;
+    constants.myGridSize = myGridSize;
+    constants.myCellSize = myCellSize;
+    constants.myTime = aTime;
+
+    vkCmdBindPipeline(aCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, myVkPipeline);
+    vkCmdBindDescriptorSets(aCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, myVkPipelineLayout, 0, 1, &myFrames[aFrameIndex].myVkDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(aCommandBuffer, myVkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(aCommandBuffer, (myObjectCount + InstanceSimulationPrivate::ourWorkgroupSize - 1) / InstanceSimulationPrivate::ourWorkgroupSize, 1, 1);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "GpuBuffer.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+class PipelineCache;
+struct AssetView;
+
+// Animates the scene's instances in a compute shader. Each frame in flight has its own instance buffer, so a frame's
+// simulation can run while earlier frames still draw from theirs.
+class InstanceSimulation
+{
+public:
+    InstanceSimulation();
+
+    void Create(VkDevice aDevice, PipelineCache& aPipelineCache, const AssetView& aShaderCode, uint32_t aFrameCount);
+    void Destroy();
+
+    // Builds a pipeline for new shader code against the existing layout, e.g. for a shader reload. Thread-safe.
+    VkPipeline CreatePipeline(PipelineCache& aPipelineCache, const AssetView& aShaderCode) const;
+    // Returns the previous pipeline, which the caller destroys once the frames recorded with it have completed.
+    VkPipeline ReplacePipeline(VkPipeline aPipeline);
+
+    // Objects are laid out on a grid of aGridSize cells of aCellSize per row. The instance buffers are shared between
+    // the given queue families.
+    void SetScene(DeviceMemoryAllocator& anAllocator, uint32_t anObjectCount, uint32_t aGridSize, float aCellSize, const std::vector<uint32_t>& someQueueFamilyIndices);
+    void DestroyScene();
+
+    void Record(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex, float aTime);
+
+    const GpuBuffer& GetInstanceBuffer(uint32_t aFrameIndex) const { return myFrames[aFrameIndex].myInstanceBuffer; }
+    bool HasScene() const { return myObjectCount > 0; }
+
+private:
+    struct FrameResources
+    {
+        GpuBuffer myInstanceBuffer;
+        VkDescriptorSet myVkDescriptorSet = nullptr;
+    };
+
+    VkDevice myVkDevice;
+    VkDescriptorSetLayout myVkDescriptorSetLayout;
+    VkDescriptorPool myVkDescriptorPool;
+    VkPipelineLayout myVkPipelineLayout;
+    VkPipeline myVkPipeline;
+    std::vector<FrameResources> myFrames;
+    uint32_t myObjectCount;
+    uint32_t myGridSize;
+    float myCellSize;
+};
@@ -0,0 +1,310 @@
+#include "JobSystem.h"
+#include "CpuTracer.h"
+
+#include <string>
+
+namespace JobSystemPrivate
+{
+    // Idle workers retry this many times before going to sleep, since new jobs tend to arrive in bursts.
+    static constexpr uint32_t ourSpinCount = 64;
+    static constexpr uint32_t ourNoQueue = UINT32_MAX;
+
+    // The system the current thread owns a deque of, and which one.
+    static thread_local JobSystem* ourCurrentSystem = nullptr;
+    static thread_local uint32_t ourQueueIndex = ourNoQueue;
+    // Rotates the first victim, so thieves do not all pile onto the same deque.
+    static thread_local uint32_t ourStealIndex = 0;
+}
+
+JobCounter::JobCounter()
+    : myCount(0)
+{
+}
+
+JobSystem::JobSystem(uint32_t aWorkerCount)
+    : mySharedQueueSize(0)
+    , myWakeCount(0)
+    , mySleepingWorkerCount(0)
+    , myIsStopping(false)
+{
+    for (uint32_t i = 0; i <= aWorkerCount; i++)
+        myQueues.push_back(std::make_unique<WorkStealingDeque<Job*>>());
+
+    JobSystemPrivate::ourCurrentSystem = this;
+    JobSystemPrivate::ourQueueIndex = 0;
+
+    for (uint32_t i = 0; i < aWorkerCount; i++)
+    {
+        myWorkers.emplace_back([this, i]()
+        {
+            CpuTracer::SetThreadName("Worker " + std::to_string(i));
+
+            JobSystemPrivate::ourCurrentSystem = this;
+            JobSystemPrivate::ourQueueIndex = i + 1;
+            JobSystemPrivate::ourStealIndex = i + 1;
+
+            WorkerLoop();
+        });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    myIsStopping.store(true);
+
+    {
+        std::lock_guard<std::mutex> lock(mySleepMutex);
+        myWakeCount++;
+    }
+
+    myWakeCondition.notify_all();
+
+    for (std::thread& worker : myWorkers)
+        worker.join();
+
+    // Jobs queued by this thread that no worker got to.
+    while (Job* job = FindJob())
+        Execute(job);
+
+    if (JobSystemPrivate::ourCurrentSystem == this)
+    {
+        JobSystemPrivate::ourCurrentSystem = nullptr;
+        JobSystemPrivate::ourQueueIndex = JobSystemPrivate::ourNoQueue;
+    }
+}
+
+void JobSystem::Run(std::function<void()> aFunction, JobCounter& aCounter)
+{
+    aCounter.myCount.fetch_add(1, std::memory_order_relaxed);
+
+    Push(new Job{ std::move(aFunction), &aCounter });
+}
+
+void JobSystem::RunAfter(JobCounter& aDependency, std::function<void()> aFunction, JobCounter& aCounter)
+{
+    aCounter.myCount.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job{ std::move(aFunction), &aCounter };
+
+    {
+        // The job that brings the count to zero takes the continuations under this lock.
+        std::lock_guard<std::mutex> lock(aDependency.myMutex);
+        if (aDependency.myCount.load(std::memory_order_acquire) != 0)
+        {
+            aDependency.myContinuations.push_back(job);
+            return;
+        }
+    }
+
+    Push(job);
+}
+
+void JobSystem::Wait(JobCounter& aCounter)
+{
+    CPU_TRACE_ZONE("WaitForJobs");
+
+    while (!aCounter.IsDone())
+    {
+        if (Job* job = FindJob())
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+
+    // The last job may still be releasing continuations, and the counter must outlive it.
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(aCounter.myMutex);
+        std::swap(exception, aCounter.myException);
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void JobSystem::ParallelFor(uint32_t aTaskCount, const std::function<void(uint32_t)>& aTask)
+{
+    if (aTaskCount == 0)
+        return;
+
+    JobCounter counter;
+    for (uint32_t i = 1; i < aTaskCount; i++)
+        Run([&aTask, i]() { aTask(i); }, counter);
+
+    // Index 0 runs here rather than waiting for a worker to wake up. Its exception, like the others', waits for the
+    // remaining tasks, which reference aTask.
+    std::exception_ptr exception;
+    try
+    {
+        aTask(0);
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    Wait(counter);
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void JobSystem::WorkerLoop()
+{
+    uint32_t failedAttemptCount = 0;
+
+    while (true)
+    {
+        if (Job* job = FindJob())
+        {
+            Execute(job);
+            failedAttemptCount = 0;
+            continue;
+        }
+
+        if (myIsStopping.load())
+            return;
+
+        if (++failedAttemptCount < JobSystemPrivate::ourSpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        Sleep();
+        failedAttemptCount = 0;
+    }
+}
+
+void JobSystem::Push(Job* aJob)
+{
+    if (JobSystemPrivate::ourCurrentSystem == this)
+    {
+        myQueues[JobSystemPrivate::ourQueueIndex]->Push(aJob);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(mySharedQueueMutex);
+        mySharedQueue.push_back(aJob);
+        mySharedQueueSize.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pairs with the fence in Sleep: either the sleeper sees the job, or this sees the sleeper.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (mySleepingWorkerCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mySleepMutex);
+        myWakeCount++;
+    }
+
+    myWakeCondition.notify_one();
+}
+
+Job* JobSystem::FindJob()
+{
+    const uint32_t queueIndex = JobSystemPrivate::ourCurrentSystem == this ? JobSystemPrivate::ourQueueIndex : JobSystemPrivate::ourNoQueue;
+
+    Job* job = nullptr;
+    if (queueIndex != JobSystemPrivate::ourNoQueue && myQueues[queueIndex]->Pop(job))
+        return job;
+
+    if (mySharedQueueSize.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(mySharedQueueMutex);
+        if (!mySharedQueue.empty())
+        {
+            job = mySharedQueue.front();
+            mySharedQueue.pop_front();
+            mySharedQueueSize.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    const uint32_t queueCount = static_cast<uint32_t>(myQueues.size());
+    const uint32_t firstVictim = JobSystemPrivate::ourStealIndex++;
+    for (uint32_t i = 0; i < queueCount; i++)
+    {
+        const uint32_t victim = (firstVictim + i) % queueCount;
+        if (victim != queueIndex && myQueues[victim]->Steal(job))
+            return job;
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Execute(Job* aJob)
+{
+    try
+    {
+        aJob->myFunction();
+    }
+    catch (...)
+    {
+        // Kept for whoever waits for the counter; letting it escape would terminate a worker.
+        std::lock_guard<std::mutex> lock(aJob->myCounter->myMutex);
+        if (!aJob->myCounter->myException)
+            aJob->myCounter->myException = std::current_exception();
+    }
+
+    JobCounter& counter = *aJob->myCounter;
+    delete aJob;
+
+    Finish(counter);
+}
+
+void JobSystem::Finish(JobCounter& aCounter)
+{
+    // Jobs that are not the last one never touch the counter after their decrement, since a waiter may destroy it.
+    uint32_t count = aCounter.myCount.load(std::memory_order_relaxed);
+    while (count > 1)
+    {
+        if (aCounter.myCount.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+    }
+
+    std::vector<Job*> continuations;
+    {
+        std::lock_guard<std::mutex> lock(aCounter.myMutex);
+        if (aCounter.myCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            std::swap(continuations, aCounter.myContinuations);
+    }
+
+    for (Job* continuation : continuations)
+        Push(continuation);
+}
+
+bool JobSystem::HasQueuedJobs() const
+{
+    if (mySharedQueueSize.load(std::memory_order_relaxed) > 0)
+        return true;
+
+    for (const std::unique_ptr<WorkStealingDeque<Job*>>& queue : myQueues)
+    {
+        if (!queue->IsEmpty())
+            return true;
+    }
+
+    return false;
+}
+
+void JobSystem::Sleep()
+{
+    std::unique_lock<std::mutex> lock(mySleepMutex);
+    const uint64_t wakeCount = myWakeCount;
+    mySleepingWorkerCount.fetch_add(1, std::memory_order_relaxed);
+    lock.unlock();
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!HasQueuedJobs())
+    {
+        lock.lock();
+        myWakeCondition.wait(lock, [this, wakeCount]() { return myWakeCount != wakeCount || myIsStopping.load(); });
+        lock.unlock();
+    }
+
+    mySleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
+}
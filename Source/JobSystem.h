@@ -0,0 +1,92 @@
+#pragma once
+
+#include "WorkStealingDeque.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+struct Job
+{
+    std::function<void()> myFunction;
+    // Decremented once the function returned. Also receives its exception, so every job has one.
+    JobCounter* myCounter = nullptr;
+};
+
+// Counts the unfinished jobs that were run with it. Must outlive them, and must not be reused for new jobs while jobs
+// scheduled to run after it are still waiting.
+class JobCounter
+{
+public:
+    JobCounter();
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return myCount.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> myCount;
+    // Guards the continuations and the exception, and is held by the job that brings the count to zero.
+    std::mutex myMutex;
+    std::vector<Job*> myContinuations;
+    std::exception_ptr myException;
+};
+
+// Work-stealing job scheduler. Every worker, and the thread that created the system, owns a Chase-Lev deque: jobs
+// are pushed to and popped from the bottom of the current thread's deque, and idle threads steal from the top of the
+// others'. Jobs run from other threads go through a shared queue. Waiting for a counter runs other jobs until it
+// reaches zero, so jobs may wait for the jobs they run without fibers. Workers with nothing to steal sleep.
+class JobSystem
+{
+public:
+    // The creating thread executes jobs while it waits, so a system without workers runs everything inline.
+    explicit JobSystem(uint32_t aWorkerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Run(std::function<void()> aFunction, JobCounter& aCounter);
+    // Queues aFunction once aDependency reaches zero. aCounter counts it from now on.
+    void RunAfter(JobCounter& aDependency, std::function<void()> aFunction, JobCounter& aCounter);
+    // Runs other jobs until aCounter reaches zero, then rethrows the first exception a job counted by it threw.
+    void Wait(JobCounter& aCounter);
+
+    // Runs aTask for every index in [0, aTaskCount) and returns once all of them finished.
+    void ParallelFor(uint32_t aTaskCount, const std::function<void(uint32_t)>& aTask);
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(myWorkers.size()); }
+
+private:
+    void WorkerLoop();
+    void Push(Job* aJob);
+    Job* FindJob();
+    void Execute(Job* aJob);
+    void Finish(JobCounter& aCounter);
+    bool HasQueuedJobs() const;
+    void Sleep();
+
+    // Index 0 belongs to the creating thread, index i to worker i - 1.
+    std::vector<std::unique_ptr<WorkStealingDeque<Job*>>> myQueues;
+    std::vector<std::thread> myWorkers;
+    std::deque<Job*> mySharedQueue;
+    std::mutex mySharedQueueMutex;
+    std::atomic<uint32_t> mySharedQueueSize;
+    std::mutex mySleepMutex;
+    std::condition_variable myWakeCondition;
+    uint64_t myWakeCount;
+    std::atomic<uint32_t> mySleepingWorkerCount;
+    std::atomic<bool> myIsStopping;
+};
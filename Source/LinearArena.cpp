@@ -0,0 +1,59 @@
+#include "LinearArena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace LinearArenaPrivate
+{
+    static constexpr VkDeviceSize ourFrameAlignment = 256;
+}
+
+LinearArena::LinearArena()
+    : myFrameCapacity(0)
+    , myFrameOffset(0)
+    , myHead(0)
+    , myPeakUsedSize(0)
+{
+}
+
+void LinearArena::Create(DeviceMemoryAllocator& anAllocator, VkDeviceSize aFrameCapacity, uint32_t aFrameCount, VkBufferUsageFlags someUsages)
+{
+    // Slices start on a boundary at least as coarse as any offset alignment Vulkan asks for.
+    myFrameCapacity = (aFrameCapacity + LinearArenaPrivate::ourFrameAlignment - 1) / LinearArenaPrivate::ourFrameAlignment * LinearArenaPrivate::ourFrameAlignment;
+    myBuffer.Create(anAllocator, myFrameCapacity * aFrameCount, someUsages, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+void LinearArena::Destroy()
+{
+    myBuffer.Destroy();
+}
+
+void LinearArena::BeginFrame(uint32_t aFrameIndex)
+{
+    myPeakUsedSize = GetPeakUsedSize();
+    myFrameOffset = myFrameCapacity * aFrameIndex;
+    myHead.store(0, std::memory_order_relaxed);
+}
+
+ArenaAllocation LinearArena::Allocate(VkDeviceSize aSize, VkDeviceSize anAlignment)
+{
+    const VkDeviceSize alignment = std::max<VkDeviceSize>(anAlignment, 1);
+
+    // Threads racing for the same head retry with the winner's end; nothing else is shared.
+    VkDeviceSize head = myHead.load(std::memory_order_relaxed);
+    VkDeviceSize offset = 0;
+    do
+    {
+        offset = (head + alignment - 1) / alignment * alignment;
+
+        if (offset + aSize > myFrameCapacity)
+            throw std::runtime_error("linear arena is out of space for this frame!");
+    } while (!myHead.compare_exchange_weak(head, offset + aSize, std::memory_order_relaxed));
+
+    ArenaAllocation allocation;
+    allocation.myVkBuffer = myBuffer.GetVkBuffer();
+    allocation.myOffset = myFrameOffset + offset;
+    allocation.myMappedData = static_cast<char*>(myBuffer.GetMappedData()) + myFrameOffset + offset;
+
+    return allocation;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "GpuBuffer.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+struct ArenaAllocation
+{
+    VkBuffer myVkBuffer = nullptr;
+    VkDeviceSize myOffset = 0;
+    void* myMappedData = nullptr;
+};
+
+// Per-frame bump allocator for transient data written by the CPU and read by the GPU within one frame.
+// Each frame in flight owns a fixed slice of one persistently mapped, host-coherent buffer, and the whole slice is
+// recycled at once. Allocate is lock-free, so recording threads can allocate from the same frame concurrently.
+class LinearArena
+{
+public:
+    LinearArena();
+
+    void Create(DeviceMemoryAllocator& anAllocator, VkDeviceSize aFrameCapacity, uint32_t aFrameCount, VkBufferUsageFlags someUsages);
+    void Destroy();
+
+    // Must be called after the frame slot's previous submission has completed, since it recycles everything the frame
+    // allocated. Not thread-safe with Allocate.
+    void BeginFrame(uint32_t aFrameIndex);
+    ArenaAllocation Allocate(VkDeviceSize aSize, VkDeviceSize anAlignment);
+
+    VkBuffer GetVkBuffer() const { return myBuffer.GetVkBuffer(); }
+    VkDeviceSize GetFrameCapacity() const { return myFrameCapacity; }
+    VkDeviceSize GetUsedSize() const { return myHead.load(std::memory_order_relaxed); }
+    VkDeviceSize GetPeakUsedSize() const { return std::max(myPeakUsedSize, GetUsedSize()); }
+
+private:
+    GpuBuffer myBuffer;
+    VkDeviceSize myFrameCapacity;
+    VkDeviceSize myFrameOffset;
+    std::atomic<VkDeviceSize> myHead;
+    VkDeviceSize myPeakUsedSize;
+};
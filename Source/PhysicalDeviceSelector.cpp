@@ -0,0 +1,252 @@
+#include "PhysicalDeviceSelector.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <iomanip>
+#include <iterator>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace PhysicalDeviceSelectorPrivate
+{
+    // Each criterion gets its own bit range, so a lower one never outweighs a higher one.
+    static constexpr uint64_t ourTypeWeight = 1ull << 32;
+    static constexpr uint64_t ourDeviceLocalGiBWeight = 1ull << 8;
+    static constexpr uint64_t ourMaxDeviceLocalGiB = 1ull << 16;
+    static constexpr uint64_t ourQueueFamilyBonus = 1ull << 6;
+
+    static uint64_t GetTypeRank(VkPhysicalDeviceType aType)
+    {
+        switch (aType)
+        {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 4;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 3;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 2;
+        case VK_PHYSICAL_DEVICE_TYPE_OTHER: return 1;
+        default: return 0;
+        }
+    }
+
+    static std::string ToLower(const std::string& aString)
+    {
+        std::string result = aString;
+        std::transform(result.begin(), result.end(), result.begin(), [](unsigned char aCharacter) { return static_cast<char>(std::tolower(aCharacter)); });
+        return result;
+    }
+}
+
+PhysicalDeviceSelector::PhysicalDeviceSelector()
+    : myIsEnumerated(false)
+{
+}
+
+void PhysicalDeviceSelector::Enumerate(VkInstance anInstance)
+{
+    if (myIsEnumerated)
+        return;
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(anInstance, &deviceCount, nullptr);
+
+    if (deviceCount == 0)
+        throw std::runtime_error("failed to find GPUs with Vulkan support!");
+
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(anInstance, &deviceCount, devices.data());
+
+    myDeviceInfos.resize(deviceCount);
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        PhysicalDeviceInfo& info = myDeviceInfos[i];
+        info.myVkPhysicalDevice = devices[i];
+        info.myIndex = i;
+
+        vkGetPhysicalDeviceProperties(devices[i], &info.myProperties);
+        vkGetPhysicalDeviceMemoryProperties(devices[i], &info.myMemoryProperties);
+        vkGetPhysicalDeviceFeatures(devices[i], &info.myFeatures);
+
+        // Device UUIDs are core from 1.1; older devices keep a zero UUID and can only be picked by index or name.
+        if (info.myProperties.apiVersion >= VK_API_VERSION_1_1)
+        {
+            info.myIdProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+            // Descriptor indexing limits are core from 1.2.
+            if (info.myProperties.apiVersion >= VK_API_VERSION_1_2)
+            {
+                info.myDescriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+                info.myIdProperties.pNext = &info.myDescriptorIndexingProperties;
+            }
+
+            VkPhysicalDeviceProperties2 properties2 = {};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext = &info.myIdProperties;
+            vkGetPhysicalDeviceProperties2(devices[i], &properties2);
+
+            info.myIdProperties.pNext = nullptr;
+            info.myDescriptorIndexingProperties.pNext = nullptr;
+        }
+
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(devices[i], nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(devices[i], nullptr, &extensionCount, extensions.data());
+
+        for (const VkExtensionProperties& extension : extensions)
+            info.myExtensionNames.push_back(extension.extensionName);
+
+        // Vulkan 1.2 features can only be queried on devices that implement 1.2, and extension features on devices
+        // that expose the extension.
+        info.myVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        info.myDynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+        if (info.myProperties.apiVersion >= VK_API_VERSION_1_2)
+        {
+            if (info.HasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+                info.myVulkan12Features.pNext = &info.myDynamicRenderingFeatures;
+
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &info.myVulkan12Features;
+            vkGetPhysicalDeviceFeatures2(devices[i], &features2);
+
+            info.myVulkan12Features.pNext = nullptr;
+            info.myDynamicRenderingFeatures.pNext = nullptr;
+        }
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &queueFamilyCount, nullptr);
+
+        info.myQueueFamilies.resize(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &queueFamilyCount, info.myQueueFamilies.data());
+    }
+
+    myIsEnumerated = true;
+}
+
+const PhysicalDeviceInfo& PhysicalDeviceSelector::Select(const std::function<bool(const PhysicalDeviceInfo&)>& anIsSuitable, const char* anOverride) const
+{
+    if (anOverride && *anOverride)
+    {
+        for (const PhysicalDeviceInfo& info : myDeviceInfos)
+        {
+            if (!MatchesOverride(info, anOverride))
+                continue;
+
+            if (!anIsSuitable(info))
+                throw std::runtime_error(std::string("the GPU selected by ") + ourOverrideVariableName + " is not suitable!");
+
+            std::cout << "Using " << info.myProperties.deviceName << " (selected by " << ourOverrideVariableName << ")" << std::endl;
+            return info;
+        }
+
+        std::cout << ourOverrideVariableName << "=" << anOverride << " matches none of the enumerated devices:" << std::endl;
+        for (const PhysicalDeviceInfo& info : myDeviceInfos)
+            std::cout << "  " << info.myIndex << ": " << info.myProperties.deviceName << " (" << GetUuidString(info.myIdProperties.deviceUUID) << ")" << std::endl;
+
+        throw std::runtime_error(std::string("failed to find the GPU selected by ") + ourOverrideVariableName + "!");
+    }
+
+    const PhysicalDeviceInfo* bestInfo = nullptr;
+    uint64_t bestScore = 0;
+    for (const PhysicalDeviceInfo& info : myDeviceInfos)
+    {
+        if (!anIsSuitable(info))
+            continue;
+
+        const uint64_t score = GetScore(info);
+        if (!bestInfo || score > bestScore)
+        {
+            bestInfo = &info;
+            bestScore = score;
+        }
+    }
+
+    if (!bestInfo)
+        throw std::runtime_error("failed to find a suitable GPU!");
+
+    std::cout << "Using " << bestInfo->myProperties.deviceName << " (score " << bestScore << ", " << myDeviceInfos.size() << " devices enumerated)" << std::endl;
+    return *bestInfo;
+}
+
+const PhysicalDeviceInfo& PhysicalDeviceSelector::GetDeviceInfo(VkPhysicalDevice aDevice) const
+{
+    for (const PhysicalDeviceInfo& info : myDeviceInfos)
+    {
+        if (info.myVkPhysicalDevice == aDevice)
+            return info;
+    }
+
+    throw std::runtime_error("failed to find an enumerated GPU!");
+}
+
+uint64_t PhysicalDeviceSelector::GetScore(const PhysicalDeviceInfo& aDeviceInfo)
+{
+    using namespace PhysicalDeviceSelectorPrivate;
+
+    uint64_t score = GetTypeRank(aDeviceInfo.myProperties.deviceType) * ourTypeWeight;
+
+    VkDeviceSize largestDeviceLocalHeap = 0;
+    for (uint32_t heapIndex = 0; heapIndex < aDeviceInfo.myMemoryProperties.memoryHeapCount; heapIndex++)
+    {
+        const VkMemoryHeap& heap = aDeviceInfo.myMemoryProperties.memoryHeaps[heapIndex];
+        if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            largestDeviceLocalHeap = std::max(largestDeviceLocalHeap, heap.size);
+    }
+
+    score += std::min<uint64_t>(largestDeviceLocalHeap >> 30, ourMaxDeviceLocalGiB) * ourDeviceLocalGiBWeight;
+
+    bool hasTransferFamily = false;
+    bool hasComputeFamily = false;
+    for (const VkQueueFamilyProperties& queueFamily : aDeviceInfo.myQueueFamilies)
+    {
+        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            continue;
+
+        hasTransferFamily |= (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
+        hasComputeFamily |= (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+    }
+
+    if (hasTransferFamily)
+        score += ourQueueFamilyBonus;
+    if (hasComputeFamily)
+        score += ourQueueFamilyBonus;
+
+    // Limits only break ties between otherwise equal devices.
+    const VkPhysicalDeviceLimits& limits = aDeviceInfo.myProperties.limits;
+    score += std::min<uint64_t>(limits.maxImageDimension2D / 1024 + limits.maxComputeWorkGroupInvocations / 256, ourQueueFamilyBonus - 1);
+
+    return score;
+}
+
+bool PhysicalDeviceSelector::MatchesOverride(const PhysicalDeviceInfo& aDeviceInfo, const std::string& anOverride) const
+{
+    using namespace PhysicalDeviceSelectorPrivate;
+
+    // Numbers that are not a device index, like "4090", are matched as a UUID or a name instead.
+    uint32_t index = 0;
+    const std::from_chars_result result = std::from_chars(anOverride.data(), anOverride.data() + anOverride.size(), index);
+    if (result.ec == std::errc() && result.ptr == anOverride.data() + anOverride.size() && index < myDeviceInfos.size())
+        return index == aDeviceInfo.myIndex;
+
+    std::string hexDigits;
+    std::copy_if(anOverride.begin(), anOverride.end(), std::back_inserter(hexDigits), [](char aCharacter) { return aCharacter != '-'; });
+
+    const bool isUuid = hexDigits.size() == 2 * VK_UUID_SIZE && std::all_of(hexDigits.begin(), hexDigits.end(), [](unsigned char aCharacter) { return std::isxdigit(aCharacter); });
+    if (isUuid)
+        return ToLower(hexDigits) == GetUuidString(aDeviceInfo.myIdProperties.deviceUUID);
+
+    return ToLower(aDeviceInfo.myProperties.deviceName).find(ToLower(anOverride)) != std::string::npos;
+}
+
+std::string PhysicalDeviceSelector::GetUuidString(const uint8_t someUuid[VK_UUID_SIZE])
+{
+    std::ostringstream stream;
+    stream << std::hex << std::setfill('0');
+
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++)
+        stream << std::setw(2) << static_cast<uint32_t>(someUuid[i]);
+
+    return stream.str();
+}
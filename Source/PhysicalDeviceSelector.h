@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Everything selection needs to know about a physical device, queried once.
+struct PhysicalDeviceInfo
+{
+    VkPhysicalDevice myVkPhysicalDevice = nullptr;
+    uint32_t myIndex = 0;
+    VkPhysicalDeviceProperties myProperties = {};
+    VkPhysicalDeviceIDProperties myIdProperties = {};
+    VkPhysicalDeviceDescriptorIndexingProperties myDescriptorIndexingProperties = {};
+    VkPhysicalDeviceMemoryProperties myMemoryProperties = {};
+    VkPhysicalDeviceFeatures myFeatures = {};
+    VkPhysicalDeviceVulkan12Features myVulkan12Features = {};
+    // Only queried when the device exposes VK_KHR_dynamic_rendering.
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR myDynamicRenderingFeatures = {};
+    std::vector<VkQueueFamilyProperties> myQueueFamilies;
+    std::vector<std::string> myExtensionNames;
+
+    bool HasExtension(const char* aName) const { return std::find(myExtensionNames.begin(), myExtensionNames.end(), aName) != myExtensionNames.end(); }
+};
+
+// Enumerates the physical devices once and picks the best suitable one by score, unless the environment variable
+// named by ourOverrideVariableName selects a device by enumeration index, device UUID or (part of) its name.
+// Scoring only looks at PhysicalDeviceInfo, so it can be exercised with mock or software ICDs on a GPU-less machine.
+class PhysicalDeviceSelector
+{
+public:
+    static constexpr const char* ourOverrideVariableName = "HELLO_VULKAN_DEVICE";
+
+    PhysicalDeviceSelector();
+
+    // Queries every device on the first call; later calls keep the cached result.
+    void Enumerate(VkInstance anInstance);
+
+    // Returns the chosen device among those accepted by anIsSuitable. An empty or null anOverride picks the highest
+    // score, earlier devices winning ties. Throws when nothing qualifies or the override matches no suitable device.
+    const PhysicalDeviceInfo& Select(const std::function<bool(const PhysicalDeviceInfo&)>& anIsSuitable, const char* anOverride) const;
+
+    const PhysicalDeviceInfo& GetDeviceInfo(VkPhysicalDevice aDevice) const;
+    const std::vector<PhysicalDeviceInfo>& GetDeviceInfos() const { return myDeviceInfos; }
+
+    // Device type dominates, then device-local memory, then dedicated transfer and async compute families, then limits.
+    static uint64_t GetScore(const PhysicalDeviceInfo& aDeviceInfo);
+    bool MatchesOverride(const PhysicalDeviceInfo& aDeviceInfo, const std::string& anOverride) const;
+    static std::string GetUuidString(const uint8_t someUuid[VK_UUID_SIZE]);
+
+private:
+    std::vector<PhysicalDeviceInfo> myDeviceInfos;
+    bool myIsEnumerated;
+};
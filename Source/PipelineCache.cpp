@@ -0,0 +1,179 @@
+#include "PipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace PipelineCachePrivate
+{
+    // Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE as written by every driver.
+    static constexpr size_t ourHeaderSize = 16 + VK_UUID_SIZE;
+
+    static uint32_t ReadUint32(const std::vector<char>& someData, size_t anOffset)
+    {
+        uint32_t value;
+        std::memcpy(&value, someData.data() + anOffset, sizeof(value));
+        return value;
+    }
+}
+
+PipelineCache::PipelineCache()
+    : myVkDevice(nullptr)
+    , myVkPipelineCache(nullptr)
+    , myVkPhysicalDeviceProperties()
+    , myIsLoadedFromDisk(false)
+    , myIsCreationFeedbackEnabled(false)
+{
+}
+
+void PipelineCache::Create(VkDevice aDevice, const VkPhysicalDeviceProperties& someProperties, const std::string& aDirectory, bool anIsCreationFeedbackEnabled)
+{
+    myVkDevice = aDevice;
+    myVkPhysicalDeviceProperties = someProperties;
+    myIsCreationFeedbackEnabled = anIsCreationFeedbackEnabled;
+    myPath = aDirectory + GetFileName();
+
+    std::vector<char> initialData;
+
+    std::ifstream file(myPath, std::ios::ate | std::ios::binary);
+    if (file.is_open())
+    {
+        initialData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(initialData.data(), initialData.size());
+        file.close();
+
+        if (!IsCompatible(initialData))
+        {
+            std::cout << "Discarding incompatible pipeline cache " << myPath << std::endl;
+            initialData.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    if (vkCreatePipelineCache(myVkDevice, &createInfo, nullptr, &myVkPipelineCache) != VK_SUCCESS)
+        throw std::runtime_error("failed to create pipeline cache!");
+
+    myIsLoadedFromDisk = !initialData.empty();
+}
+
+void PipelineCache::Save()
+{
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(myVkDevice, myVkPipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
+
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(myVkDevice, myVkPipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+        return;
+
+    std::filesystem::path path(myPath);
+    std::filesystem::path temporaryPath(myPath + ".tmp");
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(path.parent_path(), errorCode);
+
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to write pipeline cache " << temporaryPath.generic_string() << std::endl;
+        return;
+    }
+
+    file.write(data.data(), dataSize);
+    file.close();
+
+    if (file.fail())
+    {
+        std::filesystem::remove(temporaryPath, errorCode);
+        std::cerr << "Failed to write pipeline cache " << temporaryPath.generic_string() << std::endl;
+        return;
+    }
+
+    // Rename over the previous cache so a crash mid-write never leaves a truncated file behind.
+    std::filesystem::rename(temporaryPath, path, errorCode);
+    if (errorCode)
+    {
+        std::filesystem::remove(temporaryPath, errorCode);
+        std::cerr << "Failed to replace pipeline cache " << myPath << std::endl;
+    }
+}
+
+void PipelineCache::Destroy()
+{
+    vkDestroyPipelineCache(myVkDevice, myVkPipelineCache, nullptr);
+    myVkPipelineCache = nullptr;
+}
+
+const void* PipelineCache::ChainCreationFeedback(PipelineCreationFeedback& aFeedback, const void* aNext) const
+{
+    if (!myIsCreationFeedbackEnabled)
+        return aNext;
+
+    aFeedback.myCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    aFeedback.myCreateInfo.pNext = aNext;
+    aFeedback.myCreateInfo.pPipelineCreationFeedback = &aFeedback.myFeedback;
+
+    return &aFeedback.myCreateInfo;
+}
+
+void PipelineCache::RecordCreationTime(const std::string& aPipelineName, double aCreationTimeMs, const PipelineCreationFeedback& aFeedback)
+{
+    std::lock_guard<std::mutex> lock(myCreatedPipelineNamesMutex);
+
+    // Without feedback from the driver, a loaded cache or an earlier creation of the same pipeline is assumed to hit,
+    // although a driver may still ignore cache data it does not recognize.
+    bool isWarm = myIsLoadedFromDisk || myCreatedPipelineNames.count(aPipelineName) > 0;
+    if (aFeedback.myFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)
+        isWarm = (aFeedback.myFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+
+    myCreatedPipelineNames.insert(aPipelineName);
+
+    std::cout << std::fixed << std::setprecision(3)
+        << "Created pipeline " << aPipelineName << " in " << aCreationTimeMs << " ms ("
+        << (isWarm ? "warm" : "cold") << " pipeline cache)" << std::defaultfloat << std::endl;
+}
+
+bool PipelineCache::IsCompatible(const std::vector<char>& someData) const
+{
+    if (someData.size() < PipelineCachePrivate::ourHeaderSize)
+        return false;
+
+    const uint32_t headerSize = PipelineCachePrivate::ReadUint32(someData, 0);
+    const uint32_t headerVersion = PipelineCachePrivate::ReadUint32(someData, 4);
+    const uint32_t vendorID = PipelineCachePrivate::ReadUint32(someData, 8);
+    const uint32_t deviceID = PipelineCachePrivate::ReadUint32(someData, 12);
+
+    if (headerSize < PipelineCachePrivate::ourHeaderSize || headerSize > someData.size())
+        return false;
+
+    if (headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+        return false;
+
+    if (vendorID != myVkPhysicalDeviceProperties.vendorID || deviceID != myVkPhysicalDeviceProperties.deviceID)
+        return false;
+
+    return std::memcmp(someData.data() + 16, myVkPhysicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+std::string PipelineCache::GetFileName() const
+{
+    std::ostringstream fileName;
+    fileName << std::hex << std::setfill('0')
+        << std::setw(4) << myVkPhysicalDeviceProperties.vendorID << "_"
+        << std::setw(4) << myVkPhysicalDeviceProperties.deviceID << "_";
+
+    for (uint8_t byte : myVkPhysicalDeviceProperties.pipelineCacheUUID)
+        fileName << std::setw(2) << static_cast<unsigned int>(byte);
+
+    fileName << ".bin";
+    return fileName.str();
+}
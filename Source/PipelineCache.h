@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Chained into a pipeline's create info so the driver reports whether it found the pipeline in the cache.
+struct PipelineCreationFeedback
+{
+    VkPipelineCreationFeedbackEXT myFeedback = {};
+    VkPipelineCreationFeedbackCreateInfoEXT myCreateInfo = {};
+};
+
+class PipelineCache
+{
+public:
+    PipelineCache();
+
+    // anIsCreationFeedbackEnabled tells whether VK_EXT_pipeline_creation_feedback was enabled on aDevice.
+    void Create(VkDevice aDevice, const VkPhysicalDeviceProperties& someProperties, const std::string& aDirectory, bool anIsCreationFeedbackEnabled);
+    void Save();
+    void Destroy();
+
+    // Returns the pNext to put in a pipeline's create info, which is aNext itself without creation feedback.
+    const void* ChainCreationFeedback(PipelineCreationFeedback& aFeedback, const void* aNext) const;
+    // Thread-safe, so pipelines can be created on several threads at once.
+    void RecordCreationTime(const std::string& aPipelineName, double aCreationTimeMs, const PipelineCreationFeedback& aFeedback);
+
+    VkPipelineCache GetVkPipelineCache() const { return myVkPipelineCache; }
+
+private:
+    bool IsCompatible(const std::vector<char>& someData) const;
+    std::string GetFileName() const;
+
+    VkDevice myVkDevice;
+    VkPipelineCache myVkPipelineCache;
+    VkPhysicalDeviceProperties myVkPhysicalDeviceProperties;
+    std::string myPath;
+    std::set<std::string> myCreatedPipelineNames;
+    std::mutex myCreatedPipelineNamesMutex;
+    bool myIsLoadedFromDisk;
+    bool myIsCreationFeedbackEnabled;
+};
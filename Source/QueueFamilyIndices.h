@@ -8,4 +8,10 @@ struct QueueFamilyIndices
 
     std::optional<uint32_t> myGraphicsFamily;
     std::optional<uint32_t> myPresentFamily;
+
+    // Falls back to the graphics family when the device has no queue family dedicated to transfers.
+    std::optional<uint32_t> myTransferFamily;
+
+    // Falls back to the graphics family when the device has no compute family without graphics support.
+    std::optional<uint32_t> myComputeFamily;
 };
@@ -0,0 +1,861 @@
+#include "RenderGraph.h"
+#include "CpuTracer.h"
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+namespace RenderGraphPrivate
+{
+    static VkDeviceSize Align(VkDeviceSize anOffset, VkDeviceSize anAlignment)
+    {
+        return (anOffset + anAlignment - 1) / anAlignment * anAlignment;
+    }
+
+    static VkImageAspectFlags GetAspects(VkFormat aFormat)
+    {
+        switch (aFormat)
+        {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_S8_UINT:
+            return VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    static void GetFinalLayoutScope(VkImageLayout aLayout, VkPipelineStageFlags& someStages, VkAccessFlags& someAccesses)
+    {
+        switch (aLayout)
+        {
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            // The present semaphore takes care of visibility.
+            someStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            someAccesses = 0;
+            break;
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            someStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            someAccesses = VK_ACCESS_TRANSFER_READ_BIT;
+            break;
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            someStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            someAccesses = VK_ACCESS_SHADER_READ_BIT;
+            break;
+        default:
+            someStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            someAccesses = VK_ACCESS_MEMORY_READ_BIT;
+            break;
+        }
+    }
+}
+
+RenderGraph::RenderGraph()
+    : myVkDevice(nullptr)
+    , myAllocator(nullptr)
+    , myBindlessDescriptors(nullptr)
+    , myCmdBeginRendering(nullptr)
+    , myCmdEndRendering(nullptr)
+    , myUnaliasedTransientMemorySize(0)
+    , myUsesDynamicRendering(false)
+    , myIsCompiled(false)
+{
+}
+
+void RenderGraph::Create(DeviceMemoryAllocator& anAllocator, BindlessDescriptors& someBindlessDescriptors, bool aUsesDynamicRendering)
+{
+    myVkDevice = anAllocator.GetVkDevice();
+    myAllocator = &anAllocator;
+    myBindlessDescriptors = &someBindlessDescriptors;
+    myUsesDynamicRendering = aUsesDynamicRendering;
+
+    if (!myUsesDynamicRendering)
+        return;
+
+    // Extension commands are not exported by the loader on Vulkan 1.2.
+    myCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(myVkDevice, "vkCmdBeginRenderingKHR"));
+    myCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(myVkDevice, "vkCmdEndRenderingKHR"));
+
+    if (!myCmdBeginRendering || !myCmdEndRendering)
+        throw std::runtime_error("failed to load the dynamic rendering commands!");
+}
+
+void RenderGraph::Reset()
+{
+    for (Pass& pass : myPasses)
+    {
+        for (const std::pair<const std::vector<VkImageView>, VkFramebuffer>& framebuffer : pass.myVkFramebuffers)
+            vkDestroyFramebuffer(myVkDevice, framebuffer.second, nullptr);
+
+        if (pass.myVkRenderPass)
+            vkDestroyRenderPass(myVkDevice, pass.myVkRenderPass, nullptr);
+    }
+
+    for (Image& image : myImages)
+    {
+        if (image.myIsImported)
+            continue;
+
+        myBindlessDescriptors->Remove(BindlessResourceType::SampledImage, image.mySampledImageHandle, 0);
+
+        if (image.myVkImageView)
+            vkDestroyImageView(myVkDevice, image.myVkImageView, nullptr);
+
+        if (image.myVkImage)
+            vkDestroyImage(myVkDevice, image.myVkImage, nullptr);
+
+        myAllocator->Free(image.myLazyAllocation);
+    }
+
+    if (myAllocator)
+        myAllocator->Free(myTransientAllocation);
+
+    myPasses.clear();
+    myImages.clear();
+    myFinalBarrierBatch = BarrierBatch();
+    myUnaliasedTransientMemorySize = 0;
+    myIsCompiled = false;
+}
+
+RenderGraphResource RenderGraph::ImportImage(const std::string& aName, VkFormat aFormat, VkExtent2D anExtent, VkImageLayout aFinalLayout)
+{
+    Image image;
+    image.myName = aName;
+    image.myFormat = aFormat;
+    image.myExtent = anExtent;
+    image.myIsImported = true;
+    image.myFinalLayout = aFinalLayout;
+    image.myAspects = RenderGraphPrivate::GetAspects(aFormat);
+    myImages.push_back(image);
+
+    return static_cast<RenderGraphResource>(myImages.size() - 1);
+}
+
+RenderGraphResource RenderGraph::CreateImage(const std::string& aName, VkFormat aFormat, VkExtent2D anExtent, VkSampleCountFlagBits aSampleCount)
+{
+    Image image;
+    image.myName = aName;
+    image.myFormat = aFormat;
+    image.myExtent = anExtent;
+    image.mySampleCount = aSampleCount;
+    image.myAspects = RenderGraphPrivate::GetAspects(aFormat);
+    myImages.push_back(image);
+
+    return static_cast<RenderGraphResource>(myImages.size() - 1);
+}
+
+uint32_t RenderGraph::AddPass(const std::string& aName, PassCallback aCallback, VkSubpassContents aContents)
+{
+    Pass pass;
+    pass.myName = aName;
+    pass.myCallback = std::move(aCallback);
+    pass.myContents = aContents;
+    myPasses.push_back(std::move(pass));
+
+    return static_cast<uint32_t>(myPasses.size() - 1);
+}
+
+void RenderGraph::WriteColor(uint32_t aPass, RenderGraphResource anImage, const VkClearColorValue* aClearColor)
+{
+    ImageUse use;
+    use.myImage = anImage;
+    use.myAttachment = Attachment::Color;
+    use.myLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    use.myStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    use.myAccesses = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (aClearColor ? 0 : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT);
+    use.myIsWrite = true;
+    use.myIsDiscarding = aClearColor != nullptr;
+    use.myIsCleared = aClearColor != nullptr;
+    if (aClearColor)
+        use.myClearValue.color = *aClearColor;
+
+    AddUse(aPass, use, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+}
+
+void RenderGraph::WriteDepth(uint32_t aPass, RenderGraphResource anImage, const VkClearDepthStencilValue* aClearValue)
+{
+    ImageUse use;
+    use.myImage = anImage;
+    use.myAttachment = Attachment::Depth;
+    use.myLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    use.myStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    use.myAccesses = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    use.myIsWrite = true;
+    use.myIsDiscarding = aClearValue != nullptr;
+    use.myIsCleared = aClearValue != nullptr;
+    if (aClearValue)
+        use.myClearValue.depthStencil = *aClearValue;
+
+    AddUse(aPass, use, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+}
+
+void RenderGraph::ResolveColor(uint32_t aPass, RenderGraphResource aSource, RenderGraphResource aDestination)
+{
+    ImageUse use;
+    use.myImage = aDestination;
+    use.myAttachment = Attachment::Resolve;
+    use.myResolveSource = aSource;
+    use.myLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    use.myStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    use.myAccesses = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    use.myIsWrite = true;
+    use.myIsDiscarding = true;
+
+    AddUse(aPass, use, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+}
+
+void RenderGraph::ReadSampled(uint32_t aPass, RenderGraphResource anImage, VkPipelineStageFlags someStages)
+{
+    ImageUse use;
+    use.myImage = anImage;
+    use.myLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    use.myStages = someStages;
+    use.myAccesses = VK_ACCESS_SHADER_READ_BIT;
+
+    AddUse(aPass, use, VK_IMAGE_USAGE_SAMPLED_BIT);
+}
+
+void RenderGraph::Compile()
+{
+    CPU_TRACE_ZONE("CompileRenderGraph");
+
+    CullPasses();
+
+    for (uint32_t passIndex = 0; passIndex < myPasses.size(); passIndex++)
+    {
+        if (myPasses[passIndex].myIsCulled)
+            continue;
+
+        std::set<RenderGraphResource> passImages;
+        for (const ImageUse& use : myPasses[passIndex].myUses)
+        {
+            if (!passImages.insert(use.myImage).second)
+                throw std::runtime_error("render graph pass " + myPasses[passIndex].myName + " uses " + myImages[use.myImage].myName + " twice!");
+
+            Image& image = myImages[use.myImage];
+            image.myFirstPass = std::min(image.myFirstPass, passIndex);
+            image.myLastPass = std::max(image.myLastPass, passIndex);
+            image.myUsedStages |= use.myStages;
+            if (use.myIsWrite)
+                image.myWriteAccesses |= use.myAccesses;
+        }
+    }
+
+    CreateTransientImages();
+    ComputeBarriers();
+    CreateRenderPasses();
+
+    myIsCompiled = true;
+}
+
+void RenderGraph::SetImportedImage(RenderGraphResource anImage, VkImage aVkImage, VkImageView aVkImageView)
+{
+    myImages[anImage].myVkImage = aVkImage;
+    myImages[anImage].myVkImageView = aVkImageView;
+}
+
+void RenderGraph::Execute(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex, GpuProfiler& aProfiler)
+{
+    if (!myIsCompiled)
+        throw std::runtime_error("render graph executed before it was compiled!");
+
+    for (Pass& pass : myPasses)
+    {
+        if (pass.myIsCulled)
+            continue;
+
+        const uint32_t scope = aProfiler.BeginScope(aCommandBuffer, pass.myName);
+
+        RecordBarriers(aCommandBuffer, pass.myBarrierBatch);
+
+        RenderPassContext context;
+        context.myVkCommandBuffer = aCommandBuffer;
+        context.myFrameIndex = aFrameIndex;
+        context.myColorFormats = pass.myColorFormats.data();
+        context.myColorFormatCount = static_cast<uint32_t>(pass.myColorFormats.size());
+        context.myDepthFormat = pass.myDepthFormat;
+        context.mySampleCount = pass.mySampleCount;
+        context.myExtent = pass.myExtent;
+
+        if (myUsesDynamicRendering && !pass.myAttachments.empty())
+        {
+            for (size_t i = 0; i < pass.myColorImages.size(); i++)
+            {
+                pass.myColorRenderingAttachments[i].imageView = myImages[pass.myColorImages[i]].myVkImageView;
+                if (pass.myResolveImages[i] != UINT32_MAX)
+                    pass.myColorRenderingAttachments[i].resolveImageView = myImages[pass.myResolveImages[i]].myVkImageView;
+            }
+
+            if (pass.myDepthImage != UINT32_MAX)
+                pass.myDepthRenderingAttachment.imageView = myImages[pass.myDepthImage].myVkImageView;
+
+            VkRenderingInfoKHR renderingInfo = {};
+            renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+            renderingInfo.flags = pass.myContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+            renderingInfo.renderArea.offset = { 0, 0 };
+            renderingInfo.renderArea.extent = pass.myExtent;
+            renderingInfo.layerCount = 1;
+            renderingInfo.colorAttachmentCount = static_cast<uint32_t>(pass.myColorRenderingAttachments.size());
+            renderingInfo.pColorAttachments = pass.myColorRenderingAttachments.data();
+            renderingInfo.pDepthAttachment = pass.myDepthImage != UINT32_MAX ? &pass.myDepthRenderingAttachment : nullptr;
+
+            myCmdBeginRendering(aCommandBuffer, &renderingInfo);
+            pass.myCallback(context);
+            myCmdEndRendering(aCommandBuffer);
+        }
+        else if (pass.myVkRenderPass)
+        {
+            context.myVkRenderPass = pass.myVkRenderPass;
+            context.myVkFramebuffer = GetFramebuffer(pass);
+
+            VkRenderPassBeginInfo renderPassInfo = {};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass = context.myVkRenderPass;
+            renderPassInfo.framebuffer = context.myVkFramebuffer;
+            renderPassInfo.renderArea.offset = { 0, 0 };
+            renderPassInfo.renderArea.extent = pass.myExtent;
+            renderPassInfo.clearValueCount = static_cast<uint32_t>(pass.myClearValues.size());
+            renderPassInfo.pClearValues = pass.myClearValues.data();
+
+            vkCmdBeginRenderPass(aCommandBuffer, &renderPassInfo, pass.myContents);
+            pass.myCallback(context);
+            vkCmdEndRenderPass(aCommandBuffer);
+        }
+        else
+        {
+            pass.myCallback(context);
+        }
+
+        aProfiler.EndScope(aCommandBuffer, scope);
+    }
+
+    RecordBarriers(aCommandBuffer, myFinalBarrierBatch);
+}
+
+uint32_t RenderGraph::GetExecutedPassCount() const
+{
+    return static_cast<uint32_t>(std::count_if(myPasses.begin(), myPasses.end(), [](const Pass& aPass) { return !aPass.myIsCulled; }));
+}
+
+uint32_t RenderGraph::GetBarrierCount() const
+{
+    uint32_t barrierCount = myFinalBarrierBatch.myBarriers.empty() ? 0 : 1;
+    for (const Pass& pass : myPasses)
+    {
+        if (!pass.myIsCulled && !pass.myBarrierBatch.myBarriers.empty())
+            barrierCount++;
+    }
+
+    return barrierCount;
+}
+
+VkDeviceSize RenderGraph::GetLazilyAllocatedMemorySize() const
+{
+    VkDeviceSize size = 0;
+    for (const Image& image : myImages)
+    {
+        if (image.myIsLazilyAllocated)
+            size += image.myMemoryRequirements.size;
+    }
+
+    return size;
+}
+
+VkDeviceSize RenderGraph::GetCommittedLazilyAllocatedMemorySize() const
+{
+    // Lazily allocated images may share a device memory block, which is committed as a whole.
+    std::set<VkDeviceMemory> memories;
+    for (const Image& image : myImages)
+    {
+        if (image.myIsLazilyAllocated)
+            memories.insert(image.myLazyAllocation.myVkDeviceMemory);
+    }
+
+    VkDeviceSize committedSize = 0;
+    for (VkDeviceMemory memory : memories)
+    {
+        VkDeviceSize memoryCommittedSize = 0;
+        vkGetDeviceMemoryCommitment(myVkDevice, memory, &memoryCommittedSize);
+        committedSize += memoryCommittedSize;
+    }
+
+    return committedSize;
+}
+
+void RenderGraph::AddUse(uint32_t aPass, const ImageUse& aUse, VkImageUsageFlags aUsage)
+{
+    myPasses[aPass].myUses.push_back(aUse);
+    myImages[aUse.myImage].myUsage |= aUsage;
+}
+
+void RenderGraph::CullPasses()
+{
+    // Walking backwards, an image is live while some later pass or the end of the frame needs what is in it.
+    // Imported images are needed at the end, and a clear or a resolve makes earlier contents irrelevant.
+    std::vector<bool> isLive(myImages.size(), false);
+    for (size_t i = 0; i < myImages.size(); i++)
+        isLive[i] = myImages[i].myIsImported;
+
+    for (size_t i = myPasses.size(); i-- > 0;)
+    {
+        Pass& pass = myPasses[i];
+
+        pass.myIsCulled = std::none_of(pass.myUses.begin(), pass.myUses.end(), [&isLive](const ImageUse& aUse) { return aUse.myIsWrite && isLive[aUse.myImage]; });
+        if (pass.myIsCulled)
+            continue;
+
+        for (const ImageUse& use : pass.myUses)
+        {
+            if (use.myIsWrite)
+                isLive[use.myImage] = !use.myIsDiscarding;
+            else
+                isLive[use.myImage] = true;
+        }
+    }
+}
+
+void RenderGraph::CreateTransientImages()
+{
+    for (Image& image : myImages)
+    {
+        if (image.myIsImported || image.myFirstPass == UINT32_MAX)
+            continue;
+
+        // Attachments used by a single pass are never loaded or stored, so their contents can stay in tile memory.
+        const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        const bool isTransientAttachment = image.myFirstPass == image.myLastPass && (image.myUsage & ~attachmentUsage) == 0;
+        if (isTransientAttachment)
+            image.myUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = image.myFormat;
+        imageInfo.extent.width = image.myExtent.width;
+        imageInfo.extent.height = image.myExtent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = image.mySampleCount;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = image.myUsage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(myVkDevice, &imageInfo, nullptr, &image.myVkImage) != VK_SUCCESS)
+            throw std::runtime_error("failed to create render graph image " + image.myName + "!");
+
+        vkGetImageMemoryRequirements(myVkDevice, image.myVkImage, &image.myMemoryRequirements);
+
+        // Without a lazily allocated memory type they are placed like any other transient image.
+        const VkMemoryPropertyFlags lazyProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        image.myIsLazilyAllocated = isTransientAttachment && myAllocator->HasMemoryType(image.myMemoryRequirements.memoryTypeBits, lazyProperties);
+        if (image.myIsLazilyAllocated)
+            image.myLazyAllocation = myAllocator->Allocate(image.myMemoryRequirements, lazyProperties, MemoryAllocationKind::Optimal);
+    }
+
+    PlaceTransientImages();
+
+    for (Image& image : myImages)
+    {
+        if (!image.myVkImage || image.myIsImported)
+            continue;
+
+        if (image.myIsLazilyAllocated)
+            vkBindImageMemory(myVkDevice, image.myVkImage, image.myLazyAllocation.myVkDeviceMemory, image.myLazyAllocation.myOffset);
+        else
+            vkBindImageMemory(myVkDevice, image.myVkImage, myTransientAllocation.myVkDeviceMemory, myTransientAllocation.myOffset + image.myMemoryOffset);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image.myVkImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = image.myFormat;
+        viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+        viewInfo.subresourceRange.aspectMask = image.myAspects;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(myVkDevice, &viewInfo, nullptr, &image.myVkImageView) != VK_SUCCESS)
+            throw std::runtime_error("failed to create render graph image view " + image.myName + "!");
+
+        if (image.myUsage & VK_IMAGE_USAGE_SAMPLED_BIT)
+            image.mySampledImageHandle = myBindlessDescriptors->AddSampledImage(image.myVkImageView);
+    }
+}
+
+void RenderGraph::PlaceTransientImages()
+{
+    using namespace RenderGraphPrivate;
+
+    std::vector<Image*> transientImages;
+    VkMemoryRequirements requirements = {};
+    requirements.alignment = 1;
+    requirements.memoryTypeBits = ~0u;
+
+    for (Image& image : myImages)
+    {
+        if (image.myIsImported || !image.myVkImage || image.myIsLazilyAllocated)
+            continue;
+
+        transientImages.push_back(&image);
+        requirements.alignment = std::max(requirements.alignment, image.myMemoryRequirements.alignment);
+        requirements.memoryTypeBits &= image.myMemoryRequirements.memoryTypeBits;
+        myUnaliasedTransientMemorySize += Align(image.myMemoryRequirements.size, image.myMemoryRequirements.alignment);
+    }
+
+    if (transientImages.empty())
+        return;
+
+    if (requirements.memoryTypeBits == 0)
+        throw std::runtime_error("render graph images have no memory type in common!");
+
+    // Largest first, each at the lowest offset that does not overlap an image alive during any of the same passes.
+    std::stable_sort(transientImages.begin(), transientImages.end(), [](const Image* aFirst, const Image* aSecond)
+    {
+        return aFirst->myMemoryRequirements.size > aSecond->myMemoryRequirements.size;
+    });
+
+    std::vector<const Image*> placedImages;
+    for (Image* image : transientImages)
+    {
+        std::vector<const Image*> overlappingImages;
+        for (const Image* placedImage : placedImages)
+        {
+            if (placedImage->myFirstPass <= image->myLastPass && image->myFirstPass <= placedImage->myLastPass)
+                overlappingImages.push_back(placedImage);
+        }
+
+        std::sort(overlappingImages.begin(), overlappingImages.end(), [](const Image* aFirst, const Image* aSecond) { return aFirst->myMemoryOffset < aSecond->myMemoryOffset; });
+
+        VkDeviceSize offset = 0;
+        for (const Image* overlappingImage : overlappingImages)
+        {
+            if (Align(offset, image->myMemoryRequirements.alignment) + image->myMemoryRequirements.size <= overlappingImage->myMemoryOffset)
+                break;
+
+            offset = std::max(offset, overlappingImage->myMemoryOffset + overlappingImage->myMemoryRequirements.size);
+        }
+
+        image->myMemoryOffset = Align(offset, image->myMemoryRequirements.alignment);
+        requirements.size = std::max(requirements.size, image->myMemoryOffset + image->myMemoryRequirements.size);
+        placedImages.push_back(image);
+    }
+
+    myTransientAllocation = myAllocator->Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryAllocationKind::Optimal);
+}
+
+bool RenderGraph::IsAliased(const Image& anImage, const Image& anOtherImage) const
+{
+    const auto isPlaced = [](const Image& anImage) { return !anImage.myIsImported && anImage.myVkImage && !anImage.myIsLazilyAllocated; };
+
+    return isPlaced(anImage) && isPlaced(anOtherImage)
+        && anOtherImage.myMemoryOffset < anImage.myMemoryOffset + anImage.myMemoryRequirements.size
+        && anImage.myMemoryOffset < anOtherImage.myMemoryOffset + anOtherImage.myMemoryRequirements.size;
+}
+
+void RenderGraph::ComputeBarriers()
+{
+    struct ImageState
+    {
+        VkImageLayout myLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // Stages that accessed the image since it was last written, and that write's accesses.
+        VkPipelineStageFlags myStages = 0;
+        VkAccessFlags myWriteAccesses = 0;
+        bool myIsUsed = false;
+    };
+
+    std::vector<ImageState> states(myImages.size());
+
+    for (Pass& pass : myPasses)
+    {
+        if (pass.myIsCulled)
+            continue;
+
+        for (const ImageUse& use : pass.myUses)
+        {
+            const Image& image = myImages[use.myImage];
+            ImageState& state = states[use.myImage];
+
+            Barrier barrier;
+            barrier.myImage = use.myImage;
+            barrier.myNewLayout = use.myLayout;
+            barrier.myDestinationAccesses = use.myAccesses;
+
+            if (!state.myIsUsed)
+            {
+                // The previous contents are discarded. Imported images chain with whatever made them available,
+                // e.g. the acquire semaphore's wait stage. Transient images wait for every image sharing their
+                // memory, including themselves in the previous frame.
+                if (image.myIsImported)
+                {
+                    pass.myBarrierBatch.mySourceStages |= use.myStages;
+                }
+                else
+                {
+                    for (const Image& otherImage : myImages)
+                    {
+                        if (&otherImage == &image || IsAliased(image, otherImage))
+                        {
+                            pass.myBarrierBatch.mySourceStages |= otherImage.myUsedStages;
+                            barrier.mySourceAccesses |= otherImage.myWriteAccesses;
+                        }
+                    }
+                }
+
+                barrier.myOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+            else
+            {
+                // Reads of an image in the layout they need go without a barrier.
+                if (state.myLayout == use.myLayout && state.myWriteAccesses == 0 && !use.myIsWrite)
+                {
+                    state.myStages |= use.myStages;
+                    continue;
+                }
+
+                barrier.myOldLayout = state.myLayout;
+                barrier.mySourceAccesses = state.myWriteAccesses;
+                pass.myBarrierBatch.mySourceStages |= state.myStages;
+            }
+
+            pass.myBarrierBatch.myDestinationStages |= use.myStages;
+            pass.myBarrierBatch.myBarriers.push_back(barrier);
+
+            state.myLayout = use.myLayout;
+            state.myStages = use.myStages;
+            state.myWriteAccesses = use.myIsWrite ? use.myAccesses & (VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT) : 0;
+            state.myIsUsed = true;
+        }
+    }
+
+    for (size_t i = 0; i < myImages.size(); i++)
+    {
+        const Image& image = myImages[i];
+        const ImageState& state = states[i];
+
+        if (!image.myIsImported || !state.myIsUsed || (state.myLayout == image.myFinalLayout && state.myWriteAccesses == 0))
+            continue;
+
+        Barrier barrier;
+        barrier.myImage = static_cast<RenderGraphResource>(i);
+        barrier.myOldLayout = state.myLayout;
+        barrier.myNewLayout = image.myFinalLayout;
+        barrier.mySourceAccesses = state.myWriteAccesses;
+
+        VkPipelineStageFlags destinationStages = 0;
+        RenderGraphPrivate::GetFinalLayoutScope(image.myFinalLayout, destinationStages, barrier.myDestinationAccesses);
+
+        myFinalBarrierBatch.mySourceStages |= state.myStages;
+        myFinalBarrierBatch.myDestinationStages |= destinationStages;
+        myFinalBarrierBatch.myBarriers.push_back(barrier);
+    }
+}
+
+void RenderGraph::CreateRenderPasses()
+{
+    for (uint32_t passIndex = 0; passIndex < myPasses.size(); passIndex++)
+    {
+        Pass& pass = myPasses[passIndex];
+        if (pass.myIsCulled)
+            continue;
+
+        std::vector<VkAttachmentDescription> attachments;
+
+        // Layouts are handled by the graph's barriers, so the render pass leaves them alone. Contents are only
+        // loaded when an earlier pass wrote them, and only stored when a later pass or the end of the frame needs them.
+        const auto addAttachment = [&](const ImageUse& aUse)
+        {
+            const Image& image = myImages[aUse.myImage];
+
+            VkAttachmentDescription attachment = {};
+            attachment.format = image.myFormat;
+            attachment.samples = image.mySampleCount;
+            attachment.loadOp = aUse.myIsCleared ? VK_ATTACHMENT_LOAD_OP_CLEAR : (!aUse.myIsDiscarding && image.myFirstPass < passIndex ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+            attachment.storeOp = image.myIsImported || image.myLastPass > passIndex ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.stencilLoadOp = (image.myAspects & VK_IMAGE_ASPECT_STENCIL_BIT) ? attachment.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.stencilStoreOp = (image.myAspects & VK_IMAGE_ASPECT_STENCIL_BIT) ? attachment.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.initialLayout = aUse.myLayout;
+            attachment.finalLayout = aUse.myLayout;
+
+            attachments.push_back(attachment);
+            pass.myAttachments.push_back(aUse.myImage);
+            pass.myClearValues.push_back(aUse.myClearValue);
+            pass.myExtent = image.myExtent;
+
+            VkAttachmentReference reference = {};
+            reference.attachment = static_cast<uint32_t>(attachments.size() - 1);
+            reference.layout = aUse.myLayout;
+            return reference;
+        };
+
+        std::vector<VkAttachmentReference> colorReferences;
+        for (const ImageUse& use : pass.myUses)
+        {
+            if (use.myAttachment != Attachment::Color)
+                continue;
+
+            colorReferences.push_back(addAttachment(use));
+            pass.myColorImages.push_back(use.myImage);
+            pass.myColorFormats.push_back(myImages[use.myImage].myFormat);
+            pass.mySampleCount = myImages[use.myImage].mySampleCount;
+        }
+
+        std::vector<VkAttachmentReference> resolveReferences;
+        bool hasResolve = false;
+        for (RenderGraphResource colorImage : pass.myColorImages)
+        {
+            const auto resolveUse = std::find_if(pass.myUses.begin(), pass.myUses.end(), [colorImage](const ImageUse& aUse)
+            {
+                return aUse.myAttachment == Attachment::Resolve && aUse.myResolveSource == colorImage;
+            });
+
+            if (resolveUse == pass.myUses.end())
+            {
+                resolveReferences.push_back({ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+                pass.myResolveImages.push_back(UINT32_MAX);
+                continue;
+            }
+
+            resolveReferences.push_back(addAttachment(*resolveUse));
+            pass.myResolveImages.push_back(resolveUse->myImage);
+            hasResolve = true;
+        }
+
+        VkAttachmentReference depthReference = {};
+        for (const ImageUse& use : pass.myUses)
+        {
+            if (use.myAttachment == Attachment::Resolve && std::find(pass.myColorImages.begin(), pass.myColorImages.end(), use.myResolveSource) == pass.myColorImages.end())
+                throw std::runtime_error("render graph pass " + pass.myName + " resolves an image it does not render to!");
+
+            if (use.myAttachment != Attachment::Depth)
+                continue;
+
+            if (pass.myDepthImage != UINT32_MAX)
+                throw std::runtime_error("render graph pass " + pass.myName + " writes more than one depth attachment!");
+
+            depthReference = addAttachment(use);
+            pass.myDepthImage = use.myImage;
+            pass.myDepthFormat = myImages[use.myImage].myFormat;
+            pass.mySampleCount = myImages[use.myImage].mySampleCount;
+        }
+
+        if (attachments.empty())
+            continue;
+
+        if (myUsesDynamicRendering)
+        {
+            const auto getRenderingAttachment = [&attachments, &pass](const VkAttachmentReference& aReference)
+            {
+                VkRenderingAttachmentInfoKHR renderingAttachment = {};
+                renderingAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+                renderingAttachment.imageLayout = aReference.layout;
+                renderingAttachment.resolveMode = VK_RESOLVE_MODE_NONE_KHR;
+                renderingAttachment.loadOp = attachments[aReference.attachment].loadOp;
+                renderingAttachment.storeOp = attachments[aReference.attachment].storeOp;
+                renderingAttachment.clearValue = pass.myClearValues[aReference.attachment];
+                return renderingAttachment;
+            };
+
+            for (size_t i = 0; i < colorReferences.size(); i++)
+            {
+                VkRenderingAttachmentInfoKHR renderingAttachment = getRenderingAttachment(colorReferences[i]);
+                if (pass.myResolveImages[i] != UINT32_MAX)
+                {
+                    renderingAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT_KHR;
+                    renderingAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                }
+
+                pass.myColorRenderingAttachments.push_back(renderingAttachment);
+            }
+
+            if (pass.myDepthImage != UINT32_MAX)
+                pass.myDepthRenderingAttachment = getRenderingAttachment(depthReference);
+
+            continue;
+        }
+
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+        subpass.pColorAttachments = colorReferences.data();
+        subpass.pResolveAttachments = hasResolve ? resolveReferences.data() : nullptr;
+        subpass.pDepthStencilAttachment = pass.myDepthImage != UINT32_MAX ? &depthReference : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo = {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        if (vkCreateRenderPass(myVkDevice, &renderPassInfo, nullptr, &pass.myVkRenderPass) != VK_SUCCESS)
+            throw std::runtime_error("failed to create render pass for " + pass.myName + "!");
+    }
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer aCommandBuffer, const BarrierBatch& aBatch) const
+{
+    if (aBatch.myBarriers.empty())
+        return;
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(aBatch.myBarriers.size());
+
+    for (const Barrier& barrier : aBatch.myBarriers)
+    {
+        VkImageMemoryBarrier imageBarrier = {};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = barrier.mySourceAccesses;
+        imageBarrier.dstAccessMask = barrier.myDestinationAccesses;
+        imageBarrier.oldLayout = barrier.myOldLayout;
+        imageBarrier.newLayout = barrier.myNewLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = myImages[barrier.myImage].myVkImage;
+        imageBarrier.subresourceRange.aspectMask = myImages[barrier.myImage].myAspects;
+        imageBarrier.subresourceRange.baseMipLevel = 0;
+        imageBarrier.subresourceRange.levelCount = 1;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount = 1;
+        imageBarriers.push_back(imageBarrier);
+    }
+
+    vkCmdPipelineBarrier(aCommandBuffer, aBatch.mySourceStages, aBatch.myDestinationStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+VkFramebuffer RenderGraph::GetFramebuffer(Pass& aPass)
+{
+    std::vector<VkImageView> attachments;
+    for (RenderGraphResource image : aPass.myAttachments)
+        attachments.push_back(myImages[image].myVkImageView);
+
+    VkFramebuffer& framebuffer = aPass.myVkFramebuffers[attachments];
+    if (framebuffer)
+        return framebuffer;
+
+    VkFramebufferCreateInfo framebufferInfo = {};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = aPass.myVkRenderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    framebufferInfo.pAttachments = attachments.data();
+    framebufferInfo.width = aPass.myExtent.width;
+    framebufferInfo.height = aPass.myExtent.height;
+    framebufferInfo.layers = 1;
+
+    if (vkCreateFramebuffer(myVkDevice, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to create framebuffer for " + aPass.myName + "!");
+
+    return framebuffer;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "BindlessDescriptors.h"
+#include "DeviceMemoryAllocator.h"
+#include "GpuProfiler.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+using RenderGraphResource = uint32_t;
+
+struct RenderPassContext
+{
+    VkCommandBuffer myVkCommandBuffer = nullptr;
+    uint32_t myFrameIndex = 0;
+    // Set for passes that write attachments, whose callbacks record inside the render pass. With dynamic rendering
+    // there is no render pass or framebuffer, and secondary command buffers inherit the formats instead.
+    VkRenderPass myVkRenderPass = nullptr;
+    VkFramebuffer myVkFramebuffer = nullptr;
+    const VkFormat* myColorFormats = nullptr;
+    uint32_t myColorFormatCount = 0;
+    VkFormat myDepthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits mySampleCount = VK_SAMPLE_COUNT_1_BIT;
+    VkExtent2D myExtent = {};
+};
+
+// Passes declare the images they read and write. Compile drops passes whose results are never used, works out the
+// layout transitions and the pipeline barriers between the remaining ones, batched into one barrier per pass,
+// creates a render pass for each pass that writes attachments (or begins dynamic rendering with the image views
+// directly, needing no render pass or framebuffer objects), and places transient images whose lifetimes do not
+// overlap in the same memory. Compile once per configuration, e.g. again after the swap chain changes, and Execute
+// every frame. Passes run in the order they are added. Buffers are synchronized by their owners.
+// Attachments that live within a single pass, like multisampled color resolved in that pass or depth, are neither
+// loaded nor stored and get lazily allocated memory where the device has it, which tiled GPUs may never back.
+class RenderGraph
+{
+public:
+    using PassCallback = std::function<void(const RenderPassContext& aContext)>;
+
+    RenderGraph();
+
+    // With aUsesDynamicRendering, VK_KHR_dynamic_rendering must be enabled on the device.
+    void Create(DeviceMemoryAllocator& anAllocator, BindlessDescriptors& someBindlessDescriptors, bool aUsesDynamicRendering);
+    // Destroys everything Compile created and forgets every pass and resource. Only with the device idle.
+    void Reset();
+
+    // Images owned elsewhere, such as the swap chain's. Their contents are discarded at the start of the frame, and
+    // they are left in aFinalLayout at the end.
+    RenderGraphResource ImportImage(const std::string& aName, VkFormat aFormat, VkExtent2D anExtent, VkImageLayout aFinalLayout);
+    // Images that only live within a frame. The graph creates them, and they may share memory.
+    RenderGraphResource CreateImage(const std::string& aName, VkFormat aFormat, VkExtent2D anExtent, VkSampleCountFlagBits aSampleCount = VK_SAMPLE_COUNT_1_BIT);
+
+    uint32_t AddPass(const std::string& aName, PassCallback aCallback, VkSubpassContents aContents = VK_SUBPASS_CONTENTS_INLINE);
+    // Without a clear value the attachment keeps what earlier passes wrote to it.
+    void WriteColor(uint32_t aPass, RenderGraphResource anImage, const VkClearColorValue* aClearColor = nullptr);
+    void WriteDepth(uint32_t aPass, RenderGraphResource anImage, const VkClearDepthStencilValue* aClearValue = nullptr);
+    // Resolves aSource, a multisampled color attachment of the same pass, into aDestination when the pass ends.
+    void ResolveColor(uint32_t aPass, RenderGraphResource aSource, RenderGraphResource aDestination);
+    void ReadSampled(uint32_t aPass, RenderGraphResource anImage, VkPipelineStageFlags someStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    void Compile();
+
+    // Selects the image behind an imported resource for the next Execute.
+    void SetImportedImage(RenderGraphResource anImage, VkImage aVkImage, VkImageView aVkImageView);
+    void Execute(VkCommandBuffer aCommandBuffer, uint32_t aFrameIndex, GpuProfiler& aProfiler);
+
+    VkRenderPass GetVkRenderPass(uint32_t aPass) const { return myPasses[aPass].myVkRenderPass; }
+    // Bindless handle of a transient image that some pass samples.
+    uint32_t GetSampledImageHandle(RenderGraphResource anImage) const { return myImages[anImage].mySampledImageHandle; }
+
+    uint32_t GetExecutedPassCount() const;
+    uint32_t GetBarrierCount() const;
+    VkDeviceSize GetTransientMemorySize() const { return myTransientAllocation.mySize; }
+    VkDeviceSize GetUnaliasedTransientMemorySize() const { return myUnaliasedTransientMemorySize; }
+    // The size of the lazily allocated images, and how much of their memory the device has actually committed.
+    VkDeviceSize GetLazilyAllocatedMemorySize() const;
+    VkDeviceSize GetCommittedLazilyAllocatedMemorySize() const;
+
+private:
+    enum class Attachment
+    {
+        None,
+        Color,
+        Resolve,
+        Depth
+    };
+
+    struct ImageUse
+    {
+        RenderGraphResource myImage = 0;
+        Attachment myAttachment = Attachment::None;
+        // For resolve attachments, the multisampled color attachment they are resolved from.
+        RenderGraphResource myResolveSource = 0;
+        VkImageLayout myLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags myStages = 0;
+        VkAccessFlags myAccesses = 0;
+        bool myIsWrite = false;
+        // Whether the use overwrites all of the image, so that earlier contents do not matter.
+        bool myIsDiscarding = false;
+        bool myIsCleared = false;
+        VkClearValue myClearValue = {};
+    };
+
+    struct Barrier
+    {
+        RenderGraphResource myImage = 0;
+        VkImageLayout myOldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout myNewLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkAccessFlags mySourceAccesses = 0;
+        VkAccessFlags myDestinationAccesses = 0;
+    };
+
+    // Everything needed to synchronize with the commands before one point in the graph.
+    struct BarrierBatch
+    {
+        std::vector<Barrier> myBarriers;
+        VkPipelineStageFlags mySourceStages = 0;
+        VkPipelineStageFlags myDestinationStages = 0;
+    };
+
+    struct Pass
+    {
+        std::string myName;
+        PassCallback myCallback;
+        VkSubpassContents myContents = VK_SUBPASS_CONTENTS_INLINE;
+        std::vector<ImageUse> myUses;
+
+        bool myIsCulled = false;
+        BarrierBatch myBarrierBatch;
+        VkRenderPass myVkRenderPass = nullptr;
+        // In render pass attachment order: color, resolve, then depth.
+        std::vector<RenderGraphResource> myAttachments;
+        std::vector<VkClearValue> myClearValues;
+        std::vector<VkFormat> myColorFormats;
+        VkFormat myDepthFormat = VK_FORMAT_UNDEFINED;
+        VkSampleCountFlagBits mySampleCount = VK_SAMPLE_COUNT_1_BIT;
+        VkExtent2D myExtent = {};
+        // Keyed by attachment views, since imported images change from frame to frame.
+        std::map<std::vector<VkImageView>, VkFramebuffer> myVkFramebuffers;
+
+        // Dynamic rendering only; image views are filled in when the pass executes.
+        std::vector<VkRenderingAttachmentInfoKHR> myColorRenderingAttachments;
+        std::vector<RenderGraphResource> myColorImages;
+        std::vector<RenderGraphResource> myResolveImages;
+        VkRenderingAttachmentInfoKHR myDepthRenderingAttachment = {};
+        RenderGraphResource myDepthImage = UINT32_MAX;
+    };
+
+    struct Image
+    {
+        std::string myName;
+        VkFormat myFormat = VK_FORMAT_UNDEFINED;
+        VkExtent2D myExtent = {};
+        VkSampleCountFlagBits mySampleCount = VK_SAMPLE_COUNT_1_BIT;
+        bool myIsImported = false;
+        VkImageLayout myFinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkImageUsageFlags myUsage = 0;
+        VkImageAspectFlags myAspects = VK_IMAGE_ASPECT_COLOR_BIT;
+        VkImage myVkImage = nullptr;
+        VkImageView myVkImageView = nullptr;
+        uint32_t mySampledImageHandle = BindlessDescriptors::ourInvalidHandle;
+        uint32_t myFirstPass = UINT32_MAX;
+        uint32_t myLastPass = 0;
+        VkPipelineStageFlags myUsedStages = 0;
+        VkAccessFlags myWriteAccesses = 0;
+        VkMemoryRequirements myMemoryRequirements = {};
+        VkDeviceSize myMemoryOffset = 0;
+        // Lazily allocated images get memory of their own rather than a place in the shared allocation.
+        bool myIsLazilyAllocated = false;
+        MemoryAllocation myLazyAllocation;
+    };
+
+    void AddUse(uint32_t aPass, const ImageUse& aUse, VkImageUsageFlags aUsage);
+    void CullPasses();
+    void CreateTransientImages();
+    void PlaceTransientImages();
+    bool IsAliased(const Image& anImage, const Image& anOtherImage) const;
+    void ComputeBarriers();
+    void CreateRenderPasses();
+    void RecordBarriers(VkCommandBuffer aCommandBuffer, const BarrierBatch& aBatch) const;
+    VkFramebuffer GetFramebuffer(Pass& aPass);
+
+    VkDevice myVkDevice;
+    DeviceMemoryAllocator* myAllocator;
+    BindlessDescriptors* myBindlessDescriptors;
+    PFN_vkCmdBeginRenderingKHR myCmdBeginRendering;
+    PFN_vkCmdEndRenderingKHR myCmdEndRendering;
+    std::vector<Pass> myPasses;
+    std::vector<Image> myImages;
+    BarrierBatch myFinalBarrierBatch;
+    MemoryAllocation myTransientAllocation;
+    VkDeviceSize myUnaliasedTransientMemorySize;
+    bool myUsesDynamicRendering;
+    bool myIsCompiled;
+};
@@ -0,0 +1,150 @@
+#include "ShaderCompiler.h"
+#include "AssetArchiveFormat.h"
+#include "CpuTracer.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef HELLO_VULKAN_HAS_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+namespace ShaderCompilerPrivate
+{
+    // Bump when the compile options change, so stale cache entries are not picked up.
+    static constexpr uint32_t ourCacheVersion = 1;
+
+    static std::string ReadText(const std::string& aPath)
+    {
+        std::ifstream file(aPath, std::ios::binary);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open shader source " + aPath + "!");
+
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    static std::string GetCacheKey(const std::string& aSourceName, const std::string& aSource, const std::vector<std::string>& someDefines)
+    {
+        // The name picks the stage, so it is part of the key along with everything handed to the compiler.
+        std::string keyData = std::to_string(ourCacheVersion) + '\0' + aSourceName + '\0' + aSource;
+        for (const std::string& define : someDefines)
+            keyData += '\0' + define;
+
+        std::ostringstream stream;
+        stream << std::hex << std::setfill('0') << std::setw(16) << HashAssetBytes(keyData.data(), keyData.size());
+        return stream.str();
+    }
+
+#ifdef HELLO_VULKAN_HAS_SHADERC
+    static shaderc_shader_kind GetShaderKind(const std::string& aSourceName)
+    {
+        const std::string extension = std::filesystem::path(aSourceName).extension().string();
+        if (extension == ".vert")
+            return shaderc_vertex_shader;
+        if (extension == ".frag")
+            return shaderc_fragment_shader;
+        if (extension == ".comp")
+            return shaderc_compute_shader;
+
+        throw std::runtime_error("unknown shader stage for " + aSourceName + "!");
+    }
+#endif
+}
+
+bool ShaderCompiler::IsAvailable()
+{
+#ifdef HELLO_VULKAN_HAS_SHADERC
+    return true;
+#else
+    return false;
+#endif
+}
+
+ShaderCompiler::ShaderCompiler()
+{
+}
+
+void ShaderCompiler::Create(const std::string& aSourceDirectory, const std::string& aCacheDirectory)
+{
+    if (!IsAvailable())
+        throw std::runtime_error("runtime shader compilation needs a build with shaderc!");
+
+    mySourceDirectory = aSourceDirectory;
+    myCacheDirectory = aCacheDirectory;
+
+    std::filesystem::create_directories(myCacheDirectory);
+}
+
+std::vector<uint32_t> ShaderCompiler::Compile(const std::string& aSourceName, const std::vector<std::string>& someDefines) const
+{
+    CPU_TRACE_ZONE("CompileShader");
+
+    const std::string source = ShaderCompilerPrivate::ReadText(GetSourcePath(aSourceName));
+    const std::string cachePath = myCacheDirectory + aSourceName + "." + ShaderCompilerPrivate::GetCacheKey(aSourceName, source, someDefines) + ".spv";
+
+    std::ifstream cachedFile(cachePath, std::ios::ate | std::ios::binary);
+    if (cachedFile.is_open())
+    {
+        const size_t size = static_cast<size_t>(cachedFile.tellg());
+        if (size > 0 && size % sizeof(uint32_t) == 0)
+        {
+            std::vector<uint32_t> spirv(size / sizeof(uint32_t));
+            cachedFile.seekg(0);
+            if (cachedFile.read(reinterpret_cast<char*>(spirv.data()), size))
+                return spirv;
+        }
+    }
+
+#ifdef HELLO_VULKAN_HAS_SHADERC
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+
+    for (const std::string& define : someDefines)
+    {
+        const size_t separator = define.find('=');
+        if (separator == std::string::npos)
+            options.AddMacroDefinition(define);
+        else
+            options.AddMacroDefinition(define.substr(0, separator), define.substr(separator + 1));
+    }
+
+    const std::chrono::steady_clock::time_point compileStart = std::chrono::steady_clock::now();
+
+    shaderc::Compiler compiler;
+    const shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, ShaderCompilerPrivate::GetShaderKind(aSourceName), aSourceName.c_str(), options);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+        throw std::runtime_error("failed to compile " + aSourceName + ":\n" + result.GetErrorMessage());
+
+    std::vector<uint32_t> spirv(result.cbegin(), result.cend());
+
+    std::cout << std::fixed << std::setprecision(3)
+        << "Compiled shader " << aSourceName << " in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count() << " ms"
+        << std::defaultfloat << std::endl;
+
+    // Written under a per-thread name and renamed, so a concurrent reader never sees a partial file.
+    std::ostringstream temporaryPath;
+    temporaryPath << cachePath << ".tmp" << std::this_thread::get_id();
+
+    std::ofstream file(temporaryPath.str(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+    file.close();
+
+    std::error_code error;
+    if (file)
+        std::filesystem::rename(temporaryPath.str(), cachePath, error);
+    if (!file || error)
+        std::filesystem::remove(temporaryPath.str(), error);
+
+    return spirv;
+#else
+    throw std::runtime_error("runtime shader compilation needs a build with shaderc!");
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compiles GLSL sources to SPIR-V in process with shaderc. Results are cached on disk under a key hashed from the
+// source, the stage and the defines, so unchanged shaders are never compiled twice, even across runs.
+// Compile is thread-safe. Only available in builds that found shaderc (HELLO_VULKAN_HAS_SHADERC).
+class ShaderCompiler
+{
+public:
+    static bool IsAvailable();
+
+    ShaderCompiler();
+
+    void Create(const std::string& aSourceDirectory, const std::string& aCacheDirectory);
+
+    // The stage is taken from the extension (.vert, .frag or .comp). Defines are NAME or NAME=VALUE.
+    // Throws with the compiler log when the source does not compile.
+    std::vector<uint32_t> Compile(const std::string& aSourceName, const std::vector<std::string>& someDefines = {}) const;
+
+    std::string GetSourcePath(const std::string& aSourceName) const { return mySourceDirectory + aSourceName; }
+
+private:
+    std::string mySourceDirectory;
+    std::string myCacheDirectory;
+};
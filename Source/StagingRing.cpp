@@ -0,0 +1,389 @@
+#include "StagingRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace StagingRingPrivate
+{
+    static constexpr uint32_t ourSubmissionCount = 4;
+
+    // Uploaded buffers can be read by any later graphics or compute work.
+    static constexpr VkAccessFlags ourReadAccesses = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    static constexpr VkPipelineStageFlags ourReadStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    static VkCommandPool CreateCommandPool(VkDevice aDevice, uint32_t aQueueFamilyIndex)
+    {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = aQueueFamilyIndex;
+
+        VkCommandPool commandPool;
+        if (vkCreateCommandPool(aDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+            throw std::runtime_error("failed to create staging command pool!");
+
+        return commandPool;
+    }
+
+    static VkCommandBuffer AllocateCommandBuffer(VkDevice aDevice, VkCommandPool aCommandPool)
+    {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = aCommandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(aDevice, &allocInfo, &commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate staging command buffer!");
+
+        return commandBuffer;
+    }
+
+    static VkBufferMemoryBarrier GetOwnershipBarrier(VkBuffer aBuffer, uint32_t aSourceFamilyIndex, uint32_t aDestinationFamilyIndex)
+    {
+        VkBufferMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = aSourceFamilyIndex;
+        barrier.dstQueueFamilyIndex = aDestinationFamilyIndex;
+        barrier.buffer = aBuffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        return barrier;
+    }
+}
+
+StagingRing::StagingRing()
+    : myVkDevice(nullptr)
+    , myVkTransferQueue(nullptr)
+    , myVkGraphicsQueue(nullptr)
+    , myVkTransferCommandPool(nullptr)
+    , myVkGraphicsCommandPool(nullptr)
+    , myTransferFamilyIndex(0)
+    , myGraphicsFamilyIndex(0)
+    , myMappedData(nullptr)
+    , myNextSubmissionIndex(0)
+    , myFlushedTicket(0)
+    , myCompletedTicket(0)
+    , myHead(0)
+    , myTail(0)
+{
+}
+
+void StagingRing::Create(DeviceMemoryAllocator& anAllocator, VkQueue aTransferQueue, uint32_t aTransferFamilyIndex, VkQueue aGraphicsQueue, uint32_t aGraphicsFamilyIndex, VkDeviceSize aCapacity)
+{
+    myVkDevice = anAllocator.GetVkDevice();
+    myVkTransferQueue = aTransferQueue;
+    myVkGraphicsQueue = aGraphicsQueue;
+    myTransferFamilyIndex = aTransferFamilyIndex;
+    myGraphicsFamilyIndex = aGraphicsFamilyIndex;
+
+    myBuffer.Create(anAllocator, aCapacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    myMappedData = static_cast<uint8_t*>(myBuffer.GetMappedData());
+
+    myVkTransferCommandPool = StagingRingPrivate::CreateCommandPool(myVkDevice, myTransferFamilyIndex);
+    if (HasOwnershipTransfer())
+        myVkGraphicsCommandPool = StagingRingPrivate::CreateCommandPool(myVkDevice, myGraphicsFamilyIndex);
+
+    mySubmissions.resize(StagingRingPrivate::ourSubmissionCount);
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (Submission& submission : mySubmissions)
+    {
+        submission.myVkTransferCommandBuffer = StagingRingPrivate::AllocateCommandBuffer(myVkDevice, myVkTransferCommandPool);
+
+        if (vkCreateFence(myVkDevice, &fenceInfo, nullptr, &submission.myVkTransferFence) != VK_SUCCESS)
+            throw std::runtime_error("failed to create staging fence!");
+
+        if (!HasOwnershipTransfer())
+            continue;
+
+        submission.myVkAcquireCommandBuffer = StagingRingPrivate::AllocateCommandBuffer(myVkDevice, myVkGraphicsCommandPool);
+
+        if (vkCreateFence(myVkDevice, &fenceInfo, nullptr, &submission.myVkAcquireFence) != VK_SUCCESS ||
+            vkCreateSemaphore(myVkDevice, &semaphoreInfo, nullptr, &submission.myVkTransferSemaphore) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create staging synchronization objects!");
+        }
+    }
+}
+
+void StagingRing::Destroy()
+{
+    if (!myVkDevice)
+        return;
+
+    WaitIdle();
+
+    for (Submission& submission : mySubmissions)
+    {
+        vkDestroyFence(myVkDevice, submission.myVkTransferFence, nullptr);
+
+        if (HasOwnershipTransfer())
+        {
+            vkDestroyFence(myVkDevice, submission.myVkAcquireFence, nullptr);
+            vkDestroySemaphore(myVkDevice, submission.myVkTransferSemaphore, nullptr);
+        }
+    }
+
+    mySubmissions.clear();
+
+    vkDestroyCommandPool(myVkDevice, myVkTransferCommandPool, nullptr);
+    myVkTransferCommandPool = nullptr;
+
+    if (myVkGraphicsCommandPool)
+        vkDestroyCommandPool(myVkDevice, myVkGraphicsCommandPool, nullptr);
+
+    myVkGraphicsCommandPool = nullptr;
+
+    myBuffer.Destroy();
+    myMappedData = nullptr;
+}
+
+void StagingRing::Upload(const GpuBuffer& aDestination, VkDeviceSize aDestinationOffset, const void* someData, VkDeviceSize aSize)
+{
+    // Uploads larger than the ring are split into chunks that keep half of it free for the next chunk.
+    const VkDeviceSize maxChunkSize = myBuffer.GetSize() / 2;
+    const uint8_t* data = static_cast<const uint8_t*>(someData);
+
+    for (VkDeviceSize chunkStart = 0; chunkStart < aSize; chunkStart += maxChunkSize)
+    {
+        const VkDeviceSize chunkSize = std::min(maxChunkSize, aSize - chunkStart);
+        const VkDeviceSize offset = Allocate(chunkSize);
+        std::memcpy(myMappedData + offset, data + chunkStart, static_cast<size_t>(chunkSize));
+
+        VkBufferCopy region = {};
+        region.srcOffset = offset;
+        region.dstOffset = aDestinationOffset + chunkStart;
+        region.size = chunkSize;
+        myPendingCopies.push_back({ aDestination.GetVkBuffer(), region });
+    }
+}
+
+uint64_t StagingRing::Flush()
+{
+    if (myPendingCopies.empty())
+        return myFlushedTicket;
+
+    // Slots are reused round-robin, so the next one is always the oldest.
+    Submission& submission = mySubmissions[myNextSubmissionIndex];
+    if (submission.myState == SubmissionState::Transferring)
+        CompleteTransfer(submission);
+
+    if (submission.myState == SubmissionState::Acquiring)
+        WaitForAcquire(submission);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkCommandBuffer commandBuffer = submission.myVkTransferCommandBuffer;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording staging command buffer!");
+
+    // One copy command per destination buffer, carrying all of its regions.
+    std::stable_sort(myPendingCopies.begin(), myPendingCopies.end(), [](const PendingCopy& aFirst, const PendingCopy& aSecond)
+    {
+        return aFirst.myVkDestinationBuffer < aSecond.myVkDestinationBuffer;
+    });
+
+    submission.myVkDestinationBuffers.clear();
+
+    std::vector<VkBufferCopy> regions;
+    for (size_t i = 0; i < myPendingCopies.size(); i++)
+    {
+        regions.push_back(myPendingCopies[i].myRegion);
+
+        if (i + 1 == myPendingCopies.size() || myPendingCopies[i + 1].myVkDestinationBuffer != myPendingCopies[i].myVkDestinationBuffer)
+        {
+            vkCmdCopyBuffer(commandBuffer, myBuffer.GetVkBuffer(), myPendingCopies[i].myVkDestinationBuffer, static_cast<uint32_t>(regions.size()), regions.data());
+            submission.myVkDestinationBuffers.push_back(myPendingCopies[i].myVkDestinationBuffer);
+            regions.clear();
+        }
+    }
+
+    if (HasOwnershipTransfer())
+    {
+        std::vector<VkBufferMemoryBarrier> releaseBarriers;
+        for (VkBuffer destinationBuffer : submission.myVkDestinationBuffers)
+        {
+            VkBufferMemoryBarrier barrier = StagingRingPrivate::GetOwnershipBarrier(destinationBuffer, myTransferFamilyIndex, myGraphicsFamilyIndex);
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            releaseBarriers.push_back(barrier);
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(), 0, nullptr);
+    }
+    else
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = StagingRingPrivate::ourReadAccesses;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, StagingRingPrivate::ourReadStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record staging command buffer!");
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = HasOwnershipTransfer() ? 1 : 0;
+    submitInfo.pSignalSemaphores = &submission.myVkTransferSemaphore;
+
+    vkResetFences(myVkDevice, 1, &submission.myVkTransferFence);
+
+    if (vkQueueSubmit(myVkTransferQueue, 1, &submitInfo, submission.myVkTransferFence) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit staging command buffer!");
+
+    submission.myEndOffset = myHead;
+    submission.myTicket = ++myFlushedTicket;
+    submission.myState = SubmissionState::Transferring;
+    myNextSubmissionIndex = (myNextSubmissionIndex + 1) % static_cast<uint32_t>(mySubmissions.size());
+
+    // On a shared queue, submission order alone makes the copies visible to later graphics work.
+    if (!HasOwnershipTransfer())
+        myCompletedTicket = submission.myTicket;
+
+    myPendingCopies.clear();
+
+    return submission.myTicket;
+}
+
+void StagingRing::Update()
+{
+    // Transfers are handed over in submission order, so tickets complete in order too.
+    while (Submission* submission = FindOldestTransfer())
+    {
+        if (vkGetFenceStatus(myVkDevice, submission->myVkTransferFence) != VK_SUCCESS)
+            break;
+
+        CompleteTransfer(*submission);
+    }
+
+    for (Submission& submission : mySubmissions)
+    {
+        if (submission.myState == SubmissionState::Acquiring && vkGetFenceStatus(myVkDevice, submission.myVkAcquireFence) == VK_SUCCESS)
+            submission.myState = SubmissionState::Idle;
+    }
+}
+
+void StagingRing::WaitIdle()
+{
+    while (Submission* submission = FindOldestTransfer())
+        CompleteTransfer(*submission);
+
+    for (Submission& submission : mySubmissions)
+    {
+        if (submission.myState == SubmissionState::Acquiring)
+            WaitForAcquire(submission);
+    }
+}
+
+VkDeviceSize StagingRing::Allocate(VkDeviceSize aSize)
+{
+    const VkDeviceSize capacity = myBuffer.GetSize();
+    if (aSize > capacity)
+        throw std::runtime_error("upload does not fit in the staging ring!");
+
+    // Allocations never straddle the end of the ring, the remainder is skipped instead.
+    uint64_t offset = myHead;
+    if (offset % capacity + aSize > capacity)
+        offset += capacity - offset % capacity;
+
+    while (offset + aSize - myTail > capacity)
+    {
+        if (Submission* submission = FindOldestTransfer())
+            CompleteTransfer(*submission);
+        else if (!myPendingCopies.empty())
+            Flush();
+        else
+            myTail = offset;
+    }
+
+    myHead = offset + aSize;
+    return offset % capacity;
+}
+
+StagingRing::Submission* StagingRing::FindOldestTransfer()
+{
+    // Submissions are issued round-robin, so the first transferring one after the next slot is the oldest.
+    for (uint32_t i = 0; i < mySubmissions.size(); i++)
+    {
+        Submission& submission = mySubmissions[(myNextSubmissionIndex + i) % mySubmissions.size()];
+        if (submission.myState == SubmissionState::Transferring)
+            return &submission;
+    }
+
+    return nullptr;
+}
+
+void StagingRing::CompleteTransfer(Submission& aSubmission)
+{
+    vkWaitForFences(myVkDevice, 1, &aSubmission.myVkTransferFence, VK_TRUE, UINT64_MAX);
+
+    // Only the copies read the ring, so its space is free as soon as they are done.
+    myTail = std::max(myTail, aSubmission.myEndOffset);
+    aSubmission.myState = SubmissionState::Idle;
+
+    if (HasOwnershipTransfer())
+        SubmitAcquire(aSubmission);
+}
+
+void StagingRing::SubmitAcquire(Submission& aSubmission)
+{
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkCommandBuffer commandBuffer = aSubmission.myVkAcquireCommandBuffer;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording acquire command buffer!");
+
+    std::vector<VkBufferMemoryBarrier> acquireBarriers;
+    for (VkBuffer destinationBuffer : aSubmission.myVkDestinationBuffers)
+    {
+        VkBufferMemoryBarrier barrier = StagingRingPrivate::GetOwnershipBarrier(destinationBuffer, myTransferFamilyIndex, myGraphicsFamilyIndex);
+        barrier.dstAccessMask = StagingRingPrivate::ourReadAccesses;
+        acquireBarriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, StagingRingPrivate::ourReadStages, 0, 0, nullptr, static_cast<uint32_t>(acquireBarriers.size()), acquireBarriers.data(), 0, nullptr);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record acquire command buffer!");
+
+    // The transfer has already finished, so this wait never stalls the graphics queue.
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &aSubmission.myVkTransferSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkResetFences(myVkDevice, 1, &aSubmission.myVkAcquireFence);
+
+    if (vkQueueSubmit(myVkGraphicsQueue, 1, &submitInfo, aSubmission.myVkAcquireFence) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit acquire command buffer!");
+
+    aSubmission.myState = SubmissionState::Acquiring;
+    myCompletedTicket = std::max(myCompletedTicket, aSubmission.myTicket);
+}
+
+void StagingRing::WaitForAcquire(Submission& aSubmission)
+{
+    vkWaitForFences(myVkDevice, 1, &aSubmission.myVkAcquireFence, VK_TRUE, UINT64_MAX);
+    aSubmission.myState = SubmissionState::Idle;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "GpuBuffer.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+// Uploads go through one persistently mapped host-visible buffer used as a ring.
+// Copies are queued by Upload and recorded together into a single transfer submission by Flush, and ring space is
+// reclaimed once that submission's fence has signaled. Not thread-safe.
+//
+// When the transfer queue belongs to its own family, the copies run there and release the destination buffers, and
+// Update acquires them on the graphics queue once the copies are done, so the graphics queue never waits on uploads.
+class StagingRing
+{
+public:
+    StagingRing();
+
+    void Create(DeviceMemoryAllocator& anAllocator, VkQueue aTransferQueue, uint32_t aTransferFamilyIndex, VkQueue aGraphicsQueue, uint32_t aGraphicsFamilyIndex, VkDeviceSize aCapacity);
+    void Destroy();
+
+    // Copies the data into the ring right away; the copy into the destination happens on the next Flush.
+    // Uploads larger than the ring flush on their own. The destination range must not be in use by submitted graphics work.
+    void Upload(const GpuBuffer& aDestination, VkDeviceSize aDestinationOffset, const void* someData, VkDeviceSize aSize);
+
+    // Submits every queued copy without waiting and returns a ticket to pass to IsComplete.
+    uint64_t Flush();
+
+    // Hands finished transfers over to the graphics queue without blocking. Call once per frame.
+    void Update();
+
+    // True once graphics work submitted from now on is guaranteed to see the uploads of the ticket.
+    bool IsComplete(uint64_t aTicket) const { return aTicket <= myCompletedTicket; }
+    void WaitIdle();
+
+private:
+    enum class SubmissionState
+    {
+        Idle,
+        Transferring,
+        Acquiring
+    };
+
+    struct Submission
+    {
+        VkCommandBuffer myVkTransferCommandBuffer = nullptr;
+        VkCommandBuffer myVkAcquireCommandBuffer = nullptr;
+        VkFence myVkTransferFence = nullptr;
+        VkFence myVkAcquireFence = nullptr;
+        VkSemaphore myVkTransferSemaphore = nullptr;
+        std::vector<VkBuffer> myVkDestinationBuffers;
+        uint64_t myEndOffset = 0;
+        uint64_t myTicket = 0;
+        SubmissionState myState = SubmissionState::Idle;
+    };
+
+    struct PendingCopy
+    {
+        VkBuffer myVkDestinationBuffer;
+        VkBufferCopy myRegion;
+    };
+
+    VkDeviceSize Allocate(VkDeviceSize aSize);
+    Submission* FindOldestTransfer();
+    void CompleteTransfer(Submission& aSubmission);
+    void SubmitAcquire(Submission& aSubmission);
+    void WaitForAcquire(Submission& aSubmission);
+    bool HasOwnershipTransfer() const { return myTransferFamilyIndex != myGraphicsFamilyIndex; }
+
+    VkDevice myVkDevice;
+    VkQueue myVkTransferQueue;
+    VkQueue myVkGraphicsQueue;
+    VkCommandPool myVkTransferCommandPool;
+    VkCommandPool myVkGraphicsCommandPool;
+    uint32_t myTransferFamilyIndex;
+    uint32_t myGraphicsFamilyIndex;
+    GpuBuffer myBuffer;
+    uint8_t* myMappedData;
+    std::vector<Submission> mySubmissions;
+    std::vector<PendingCopy> myPendingCopies;
+    uint32_t myNextSubmissionIndex;
+    uint64_t myFlushedTicket;
+    uint64_t myCompletedTicket;
+
+    // Offsets grow monotonically and wrap modulo the capacity, so head - tail is the number of bytes in use.
+    uint64_t myHead;
+    uint64_t myTail;
+};
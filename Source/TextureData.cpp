@@ -0,0 +1,165 @@
+#include "TextureData.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace TextureDataPrivate
+{
+    static constexpr uint8_t ourKtx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    // Little-endian, as written by every KTX2 tool; the fields after the identifier are naturally aligned.
+    struct Ktx2Header
+    {
+        uint8_t myIdentifier[12];
+        uint32_t myVkFormat;
+        uint32_t myTypeSize;
+        uint32_t myPixelWidth;
+        uint32_t myPixelHeight;
+        uint32_t myPixelDepth;
+        uint32_t myLayerCount;
+        uint32_t myFaceCount;
+        uint32_t myLevelCount;
+        uint32_t mySupercompressionScheme;
+        uint32_t myDfdByteOffset;
+        uint32_t myDfdByteLength;
+        uint32_t myKvdByteOffset;
+        uint32_t myKvdByteLength;
+        uint64_t mySgdByteOffset;
+        uint64_t mySgdByteLength;
+    };
+
+    struct Ktx2LevelIndex
+    {
+        uint64_t myByteOffset;
+        uint64_t myByteLength;
+        uint64_t myUncompressedByteLength;
+    };
+
+    static_assert(sizeof(Ktx2Header) == 80, "KTX2 header layout changed");
+    static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index layout changed");
+}
+
+bool GetTextureFormatInfo(VkFormat aFormat, TextureFormatInfo& aFormatInfo)
+{
+    switch (aFormat)
+    {
+    case VK_FORMAT_R8_UNORM:
+        aFormatInfo = { 1, 1, 1 };
+        return true;
+    case VK_FORMAT_R8G8_UNORM:
+        aFormatInfo = { 2, 1, 1 };
+        return true;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        aFormatInfo = { 4, 1, 1 };
+        return true;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        aFormatInfo = { 8, 1, 1 };
+        return true;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        aFormatInfo = { 16, 1, 1 };
+        return true;
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+        aFormatInfo = { 8, 4, 4 };
+        return true;
+    case VK_FORMAT_BC2_UNORM_BLOCK:
+    case VK_FORMAT_BC2_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+    case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        aFormatInfo = { 16, 4, 4 };
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool IsBlockCompressed(VkFormat aFormat)
+{
+    TextureFormatInfo formatInfo;
+    return GetTextureFormatInfo(aFormat, formatInfo) && formatInfo.myBlockWidth > 1;
+}
+
+uint32_t GetMipLevelCount(uint32_t aWidth, uint32_t aHeight)
+{
+    uint32_t levelCount = 1;
+    for (uint32_t size = std::max(aWidth, aHeight); size > 1; size /= 2)
+        levelCount++;
+
+    return levelCount;
+}
+
+uint32_t GetBlockRowCount(const TextureFormatInfo& aFormatInfo, uint32_t aHeight)
+{
+    return (aHeight + aFormatInfo.myBlockHeight - 1) / aFormatInfo.myBlockHeight;
+}
+
+VkDeviceSize GetBlockRowSize(const TextureFormatInfo& aFormatInfo, uint32_t aWidth)
+{
+    return static_cast<VkDeviceSize>((aWidth + aFormatInfo.myBlockWidth - 1) / aFormatInfo.myBlockWidth) * aFormatInfo.myBlockSize;
+}
+
+TextureData ParseKtx2(const void* someData, size_t aSize)
+{
+    using namespace TextureDataPrivate;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(someData);
+
+    Ktx2Header header;
+    if (aSize < sizeof(header))
+        throw std::runtime_error("KTX2 file is truncated!");
+
+    std::memcpy(&header, bytes, sizeof(header));
+
+    if (std::memcmp(header.myIdentifier, ourKtx2Identifier, sizeof(ourKtx2Identifier)) != 0)
+        throw std::runtime_error("not a KTX2 file!");
+    if (header.mySupercompressionScheme != 0 || header.myVkFormat == VK_FORMAT_UNDEFINED)
+        throw std::runtime_error("supercompressed KTX2 textures are not supported!");
+    if (header.myPixelWidth == 0 || header.myPixelHeight == 0 || header.myPixelDepth > 1 || header.myLayerCount > 1 || header.myFaceCount != 1)
+        throw std::runtime_error("only single 2D KTX2 images are supported!");
+
+    TextureData texture;
+    texture.myFormat = static_cast<VkFormat>(header.myVkFormat);
+    texture.myGeneratesMips = header.myLevelCount == 0;
+
+    TextureFormatInfo formatInfo;
+    if (!GetTextureFormatInfo(texture.myFormat, formatInfo))
+        throw std::runtime_error("unsupported KTX2 texture format!");
+
+    const uint32_t levelCount = std::max(header.myLevelCount, 1u);
+    if (levelCount > GetMipLevelCount(header.myPixelWidth, header.myPixelHeight) || sizeof(header) + static_cast<size_t>(levelCount) * sizeof(Ktx2LevelIndex) > aSize)
+        throw std::runtime_error("KTX2 level index is invalid!");
+
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        Ktx2LevelIndex levelIndex;
+        std::memcpy(&levelIndex, bytes + sizeof(header) + level * sizeof(Ktx2LevelIndex), sizeof(levelIndex));
+
+        TextureLevel textureLevel;
+        textureLevel.myWidth = std::max(header.myPixelWidth >> level, 1u);
+        textureLevel.myHeight = std::max(header.myPixelHeight >> level, 1u);
+
+        const VkDeviceSize expectedSize = GetBlockRowSize(formatInfo, textureLevel.myWidth) * GetBlockRowCount(formatInfo, textureLevel.myHeight);
+        if (levelIndex.myByteLength != expectedSize || levelIndex.myByteOffset > aSize || levelIndex.myByteLength > aSize - levelIndex.myByteOffset)
+            throw std::runtime_error("KTX2 level data is out of bounds!");
+
+        textureLevel.myData = bytes + levelIndex.myByteOffset;
+        textureLevel.mySize = static_cast<size_t>(levelIndex.myByteLength);
+        texture.myLevels.push_back(textureLevel);
+    }
+
+    return texture;
+}
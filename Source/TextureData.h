@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Texels are stored in blocks: 1x1 for uncompressed formats, 4x4 for BCn.
+struct TextureFormatInfo
+{
+    uint32_t myBlockSize = 0;
+    uint32_t myBlockWidth = 1;
+    uint32_t myBlockHeight = 1;
+};
+
+struct TextureLevel
+{
+    const uint8_t* myData = nullptr;
+    size_t mySize = 0;
+    uint32_t myWidth = 0;
+    uint32_t myHeight = 0;
+};
+
+// The mip levels of a 2D texture, finest first, viewing memory owned by the caller. When myGeneratesMips is set,
+// only the base level is given and the rest of the chain is generated on the GPU.
+struct TextureData
+{
+    VkFormat myFormat = VK_FORMAT_UNDEFINED;
+    std::vector<TextureLevel> myLevels;
+    bool myGeneratesMips = false;
+};
+
+// Returns false for formats the texture streamer does not handle.
+bool GetTextureFormatInfo(VkFormat aFormat, TextureFormatInfo& aFormatInfo);
+bool IsBlockCompressed(VkFormat aFormat);
+uint32_t GetMipLevelCount(uint32_t aWidth, uint32_t aHeight);
+uint32_t GetBlockRowCount(const TextureFormatInfo& aFormatInfo, uint32_t aHeight);
+VkDeviceSize GetBlockRowSize(const TextureFormatInfo& aFormatInfo, uint32_t aWidth);
+
+// Reads a KTX2 file holding one 2D image without supercompression; Basis Universal payloads would need transcoding.
+// A file that stores no mip levels (level count 0) asks for them to be generated. Throws on anything else.
+// The returned levels point into someData.
+TextureData ParseKtx2(const void* someData, size_t aSize);
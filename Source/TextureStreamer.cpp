@@ -0,0 +1,446 @@
+#include "TextureStreamer.h"
+#include "CpuTracer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace TextureStreamerPrivate
+{
+    // Buffer offsets of image copies must be multiples of 4 and of the texel block size.
+    static constexpr VkDeviceSize ourCopyAlignment = 16;
+    static constexpr float ourMaxAnisotropy = 16.0f;
+
+    static const uint8_t ourFallbackPixel[4] = { 255, 255, 255, 255 };
+
+    static VkImageMemoryBarrier GetLevelBarrier(VkImage anImage, uint32_t aLevel, VkImageLayout anOldLayout, VkImageLayout aNewLayout, VkAccessFlags aSourceAccess, VkAccessFlags aDestinationAccess)
+    {
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = aSourceAccess;
+        barrier.dstAccessMask = aDestinationAccess;
+        barrier.oldLayout = anOldLayout;
+        barrier.newLayout = aNewLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = anImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = aLevel;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        return barrier;
+    }
+}
+
+TextureStreamer::TextureStreamer()
+    : myVkDevice(nullptr)
+    , myVkPhysicalDevice(nullptr)
+    , myVkSampler(nullptr)
+    , myAllocator(nullptr)
+    , myBindlessDescriptors(nullptr)
+    , myFallbackTextureId(ourInvalidTextureId)
+    , mySamplerHandle(BindlessDescriptors::ourInvalidHandle)
+    , myAllocatedBytes(0)
+    , myMemoryBudget(0)
+    , myIsBlockCompressionEnabled(false)
+{
+}
+
+void TextureStreamer::Create(VkPhysicalDevice aPhysicalDevice, const VkPhysicalDeviceFeatures& someEnabledFeatures, const VkPhysicalDeviceLimits& someLimits, DeviceMemoryAllocator& anAllocator, BindlessDescriptors& someBindlessDescriptors, uint32_t aFrameCount, VkDeviceSize anUploadBudget, VkDeviceSize aMemoryBudget)
+{
+    myVkDevice = anAllocator.GetVkDevice();
+    myVkPhysicalDevice = aPhysicalDevice;
+    myAllocator = &anAllocator;
+    myBindlessDescriptors = &someBindlessDescriptors;
+    myMemoryBudget = aMemoryBudget;
+    myIsBlockCompressionEnabled = someEnabledFeatures.textureCompressionBC == VK_TRUE;
+
+    myStagingArena.Create(anAllocator, anUploadBudget, aFrameCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.anisotropyEnable = someEnabledFeatures.samplerAnisotropy;
+    samplerInfo.maxAnisotropy = std::min(TextureStreamerPrivate::ourMaxAnisotropy, someLimits.maxSamplerAnisotropy);
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(myVkDevice, &samplerInfo, nullptr, &myVkSampler) != VK_SUCCESS)
+        throw std::runtime_error("failed to create texture sampler!");
+
+    mySamplerHandle = myBindlessDescriptors->AddSampler(myVkSampler);
+
+    TextureData fallback;
+    fallback.myFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    fallback.myLevels.push_back({ TextureStreamerPrivate::ourFallbackPixel, sizeof(TextureStreamerPrivate::ourFallbackPixel), 1, 1 });
+    myFallbackTextureId = Request(fallback);
+}
+
+void TextureStreamer::Destroy()
+{
+    if (!myVkDevice)
+        return;
+
+    for (RetiredResource& resource : myRetiredResources)
+        DestroyResource(resource);
+
+    for (Texture& texture : myTextures)
+    {
+        RetiredResource resource;
+        resource.myVkImage = texture.myVkImage;
+        resource.myVkImageView = texture.myVkImageView;
+        resource.myAllocation = texture.myAllocation;
+        DestroyResource(resource);
+    }
+
+    myRetiredResources.clear();
+    myTextures.clear();
+    myFreeTextureIds.clear();
+    myPendingTextureIds.clear();
+
+    vkDestroySampler(myVkDevice, myVkSampler, nullptr);
+    myStagingArena.Destroy();
+
+    myVkSampler = nullptr;
+    myFallbackTextureId = ourInvalidTextureId;
+    mySamplerHandle = BindlessDescriptors::ourInvalidHandle;
+    myAllocatedBytes = 0;
+    myVkDevice = nullptr;
+}
+
+TextureId TextureStreamer::Request(const TextureData& aTexture)
+{
+    using namespace TextureStreamerPrivate;
+
+    Texture texture;
+    texture.mySource = aTexture;
+
+    if (texture.mySource.myLevels.empty() || !GetTextureFormatInfo(texture.mySource.myFormat, texture.myFormatInfo))
+        throw std::runtime_error("texture has no levels or an unsupported format!");
+
+    if (IsBlockCompressed(texture.mySource.myFormat) && !myIsBlockCompressionEnabled)
+        throw std::runtime_error("block-compressed textures need the textureCompressionBC feature!");
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(myVkPhysicalDevice, texture.mySource.myFormat, &formatProperties);
+
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        throw std::runtime_error("texture format cannot be sampled on this device!");
+
+    // Without linear blits the base level is all there is.
+    const VkFormatFeatureFlags mipGenerationFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    texture.myGeneratesMips = texture.mySource.myGeneratesMips && (formatProperties.optimalTilingFeatures & mipGenerationFeatures) == mipGenerationFeatures;
+
+    // Drop the finest levels until the image fits the budget. Generated chains only have their base level to drop.
+    for (;;)
+    {
+        const TextureLevel& baseLevel = texture.mySource.myLevels.front();
+        texture.myLevelCount = texture.myGeneratesMips ? GetMipLevelCount(baseLevel.myWidth, baseLevel.myHeight) : static_cast<uint32_t>(texture.mySource.myLevels.size());
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = texture.mySource.myFormat;
+        imageInfo.extent.width = baseLevel.myWidth;
+        imageInfo.extent.height = baseLevel.myHeight;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = texture.myLevelCount;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (texture.myGeneratesMips ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(myVkDevice, &imageInfo, nullptr, &texture.myVkImage) != VK_SUCCESS)
+            throw std::runtime_error("failed to create texture image!");
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(myVkDevice, texture.myVkImage, &memoryRequirements);
+
+        if (myAllocatedBytes + memoryRequirements.size <= myMemoryBudget)
+            break;
+
+        vkDestroyImage(myVkDevice, texture.myVkImage, nullptr);
+        texture.myVkImage = nullptr;
+
+        if (texture.myGeneratesMips || texture.mySource.myLevels.size() == 1)
+            throw std::runtime_error("texture does not fit in the texture memory budget!");
+
+        texture.mySource.myLevels.erase(texture.mySource.myLevels.begin());
+    }
+
+    // A row that does not fit in one frame's staging slice would never be uploaded.
+    const TextureLevel& baseLevel = texture.mySource.myLevels.front();
+    if (GetBlockRowSize(texture.myFormatInfo, baseLevel.myWidth) > myStagingArena.GetFrameCapacity() - ourCopyAlignment)
+    {
+        vkDestroyImage(myVkDevice, texture.myVkImage, nullptr);
+        throw std::runtime_error("texture rows exceed the per-frame upload budget!");
+    }
+
+    texture.myAllocation = myAllocator->AllocateForImage(texture.myVkImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    myAllocatedBytes += texture.myAllocation.mySize;
+
+    texture.myResidentLevel = texture.myLevelCount;
+    texture.myUploadLevel = texture.myGeneratesMips ? 0 : texture.myLevelCount - 1;
+    texture.myIsUsed = true;
+
+    TextureId textureId;
+    if (!myFreeTextureIds.empty())
+    {
+        textureId = myFreeTextureIds.back();
+        myFreeTextureIds.pop_back();
+        myTextures[textureId] = std::move(texture);
+    }
+    else
+    {
+        textureId = static_cast<TextureId>(myTextures.size());
+        myTextures.push_back(std::move(texture));
+    }
+
+    myPendingTextureIds.push_back(textureId);
+    return textureId;
+}
+
+void TextureStreamer::Release(TextureId aTextureId, uint64_t aLastFrameValue)
+{
+    if (aTextureId == ourInvalidTextureId || aTextureId == myFallbackTextureId)
+        return;
+
+    Texture& texture = myTextures[aTextureId];
+
+    RetiredResource resource;
+    resource.myVkImage = texture.myVkImage;
+    resource.myVkImageView = texture.myVkImageView;
+    resource.myAllocation = texture.myAllocation;
+    resource.myLastFrameValue = aLastFrameValue;
+    myRetiredResources.push_back(resource);
+
+    myBindlessDescriptors->Remove(BindlessResourceType::SampledImage, texture.myHandle, aLastFrameValue);
+    myPendingTextureIds.erase(std::remove(myPendingTextureIds.begin(), myPendingTextureIds.end(), aTextureId), myPendingTextureIds.end());
+
+    texture = Texture();
+    myFreeTextureIds.push_back(aTextureId);
+}
+
+void TextureStreamer::BeginFrame(uint32_t aFrameIndex, uint64_t aCompletedFrameValue)
+{
+    myStagingArena.BeginFrame(aFrameIndex);
+
+    for (size_t i = 0; i < myRetiredResources.size();)
+    {
+        if (myRetiredResources[i].myLastFrameValue > aCompletedFrameValue)
+        {
+            i++;
+            continue;
+        }
+
+        DestroyResource(myRetiredResources[i]);
+        myRetiredResources[i] = myRetiredResources.back();
+        myRetiredResources.pop_back();
+    }
+}
+
+void TextureStreamer::Record(VkCommandBuffer aCommandBuffer, uint64_t aFrameValue)
+{
+    CPU_TRACE_ZONE("StreamTextures");
+
+    // One level per texture per sweep, so coarse levels of every pending texture go before fine ones.
+    bool hasProgressed = true;
+    while (hasProgressed && !myPendingTextureIds.empty())
+    {
+        hasProgressed = false;
+
+        for (size_t i = 0; i < myPendingTextureIds.size();)
+        {
+            Texture& texture = myTextures[myPendingTextureIds[i]];
+            if (!UploadRows(aCommandBuffer, texture))
+                return;
+
+            hasProgressed = true;
+
+            const uint32_t rowCount = GetBlockRowCount(texture.myFormatInfo, texture.mySource.myLevels[texture.myUploadLevel].myHeight);
+            if (texture.myUploadedRowCount < rowCount)
+                return;
+
+            if (FinishLevel(aCommandBuffer, texture, aFrameValue))
+                myPendingTextureIds.erase(myPendingTextureIds.begin() + i);
+            else
+                i++;
+        }
+    }
+}
+
+uint32_t TextureStreamer::GetSampledImageHandle(TextureId aTextureId) const
+{
+    if (aTextureId != ourInvalidTextureId && myTextures[aTextureId].myHandle != BindlessDescriptors::ourInvalidHandle)
+        return myTextures[aTextureId].myHandle;
+
+    return myTextures[myFallbackTextureId].myHandle;
+}
+
+bool TextureStreamer::IsResident(TextureId aTextureId) const
+{
+    return myTextures[aTextureId].myIsUsed && myTextures[aTextureId].myResidentLevel == 0;
+}
+
+bool TextureStreamer::UploadRows(VkCommandBuffer aCommandBuffer, Texture& aTexture)
+{
+    using namespace TextureStreamerPrivate;
+
+    const TextureLevel& level = aTexture.mySource.myLevels[aTexture.myUploadLevel];
+    const uint32_t rowCount = GetBlockRowCount(aTexture.myFormatInfo, level.myHeight);
+    const VkDeviceSize rowSize = GetBlockRowSize(aTexture.myFormatInfo, level.myWidth);
+
+    const VkDeviceSize stagingOffset = (myStagingArena.GetUsedSize() + ourCopyAlignment - 1) / ourCopyAlignment * ourCopyAlignment;
+    if (stagingOffset >= myStagingArena.GetFrameCapacity())
+        return false;
+
+    const uint32_t copyRowCount = static_cast<uint32_t>(std::min<VkDeviceSize>(rowCount - aTexture.myUploadedRowCount, (myStagingArena.GetFrameCapacity() - stagingOffset) / rowSize));
+    if (copyRowCount == 0)
+        return false;
+
+    if (aTexture.myUploadedRowCount == 0)
+    {
+        VkImageMemoryBarrier barrier = GetLevelBarrier(aTexture.myVkImage, aTexture.myUploadLevel, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    const VkDeviceSize copySize = copyRowCount * rowSize;
+    const ArenaAllocation staging = myStagingArena.Allocate(copySize, ourCopyAlignment);
+    std::memcpy(staging.myMappedData, level.myData + aTexture.myUploadedRowCount * rowSize, static_cast<size_t>(copySize));
+
+    const uint32_t firstTexelRow = aTexture.myUploadedRowCount * aTexture.myFormatInfo.myBlockHeight;
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = staging.myOffset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = aTexture.myUploadLevel;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { 0, static_cast<int32_t>(firstTexelRow), 0 };
+    region.imageExtent = { level.myWidth, std::min(copyRowCount * aTexture.myFormatInfo.myBlockHeight, level.myHeight - firstTexelRow), 1 };
+
+    vkCmdCopyBufferToImage(aCommandBuffer, staging.myVkBuffer, aTexture.myVkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    aTexture.myUploadedRowCount += copyRowCount;
+    return true;
+}
+
+bool TextureStreamer::FinishLevel(VkCommandBuffer aCommandBuffer, Texture& aTexture, uint64_t aFrameValue)
+{
+    if (aTexture.myGeneratesMips)
+    {
+        GenerateMips(aCommandBuffer, aTexture);
+        aTexture.myResidentLevel = 0;
+    }
+    else
+    {
+        VkImageMemoryBarrier barrier = TextureStreamerPrivate::GetLevelBarrier(aTexture.myVkImage, aTexture.myUploadLevel, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        aTexture.myResidentLevel = aTexture.myUploadLevel;
+    }
+
+    UpdateView(aTexture, aFrameValue);
+    aTexture.myUploadedRowCount = 0;
+
+    if (aTexture.myResidentLevel == 0)
+        return true;
+
+    aTexture.myUploadLevel--;
+    return false;
+}
+
+void TextureStreamer::GenerateMips(VkCommandBuffer aCommandBuffer, const Texture& aTexture) const
+{
+    using namespace TextureStreamerPrivate;
+
+    int32_t width = static_cast<int32_t>(aTexture.mySource.myLevels.front().myWidth);
+    int32_t height = static_cast<int32_t>(aTexture.mySource.myLevels.front().myHeight);
+
+    // Each level is blitted from the one above it, which is then done and handed to the shaders.
+    for (uint32_t level = 1; level < aTexture.myLevelCount; level++)
+    {
+        const VkImageMemoryBarrier blitBarriers[] =
+        {
+            GetLevelBarrier(aTexture.myVkImage, level - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT),
+            GetLevelBarrier(aTexture.myVkImage, level, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT)
+        };
+        vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, blitBarriers);
+
+        const int32_t levelWidth = std::max(width / 2, 1);
+        const int32_t levelHeight = std::max(height / 2, 1);
+
+        VkImageBlit blit = {};
+        blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+        blit.srcOffsets[1] = { width, height, 1 };
+        blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        blit.dstOffsets[1] = { levelWidth, levelHeight, 1 };
+        vkCmdBlitImage(aCommandBuffer, aTexture.myVkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, aTexture.myVkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        VkImageMemoryBarrier readBarrier = GetLevelBarrier(aTexture.myVkImage, level - 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &readBarrier);
+
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    VkImageMemoryBarrier lastBarrier = GetLevelBarrier(aTexture.myVkImage, aTexture.myLevelCount - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(aCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &lastBarrier);
+}
+
+void TextureStreamer::UpdateView(Texture& aTexture, uint64_t aFrameValue)
+{
+    // Levels that have not arrived are still undefined, so the view only covers the resident ones. It gets a new
+    // handle, since frames in flight may still sample through the old one.
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = aTexture.myVkImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = aTexture.mySource.myFormat;
+    viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    viewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = aTexture.myResidentLevel;
+    viewInfo.subresourceRange.levelCount = aTexture.myLevelCount - aTexture.myResidentLevel;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VkImageView imageView;
+    if (vkCreateImageView(myVkDevice, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+        throw std::runtime_error("failed to create texture image view!");
+
+    if (aTexture.myVkImageView)
+    {
+        RetiredResource resource;
+        resource.myVkImageView = aTexture.myVkImageView;
+        resource.myLastFrameValue = aFrameValue;
+        myRetiredResources.push_back(resource);
+
+        myBindlessDescriptors->Remove(BindlessResourceType::SampledImage, aTexture.myHandle, aFrameValue);
+    }
+
+    aTexture.myVkImageView = imageView;
+    aTexture.myHandle = myBindlessDescriptors->AddSampledImage(imageView);
+}
+
+void TextureStreamer::DestroyResource(RetiredResource& aResource)
+{
+    if (aResource.myVkImageView)
+        vkDestroyImageView(myVkDevice, aResource.myVkImageView, nullptr);
+
+    if (aResource.myVkImage)
+        vkDestroyImage(myVkDevice, aResource.myVkImage, nullptr);
+
+    myAllocatedBytes -= aResource.myAllocation.mySize;
+    myAllocator->Free(aResource.myAllocation);
+}
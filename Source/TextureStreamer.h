@@ -0,0 +1,99 @@
+#pragma once
+
+#include "BindlessDescriptors.h"
+#include "DeviceMemoryAllocator.h"
+#include "LinearArena.h"
+#include "TextureData.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+using TextureId = uint32_t;
+
+// Streams textures into device-local images a slice at a time. Each frame copies at most its upload budget out of a
+// per-frame staging arena, recorded into that frame's command buffer ahead of rendering, so streaming never blocks
+// the CPU or waits on a queue. Levels arrive coarsest first and become sampleable as soon as they land, and pending
+// textures take turns, so all of them get a low-resolution version before any gets its finest level. Until then,
+// a texture's handle refers to a 1x1 white fallback.
+// Images live under a memory budget: a texture that would exceed it drops its finest levels. Not thread-safe.
+class TextureStreamer
+{
+public:
+    static constexpr TextureId ourInvalidTextureId = UINT32_MAX;
+
+    TextureStreamer();
+
+    void Create(VkPhysicalDevice aPhysicalDevice, const VkPhysicalDeviceFeatures& someEnabledFeatures, const VkPhysicalDeviceLimits& someLimits, DeviceMemoryAllocator& anAllocator, BindlessDescriptors& someBindlessDescriptors, uint32_t aFrameCount, VkDeviceSize anUploadBudget, VkDeviceSize aMemoryBudget);
+    void Destroy();
+
+    // The level data is read while the texture streams, so it has to stay valid until IsResident or Release.
+    TextureId Request(const TextureData& aTexture);
+    // aLastFrameValue is the last frame that may sample the texture.
+    void Release(TextureId aTextureId, uint64_t aLastFrameValue);
+
+    // Must be called after the frame slot's previous submission has completed.
+    void BeginFrame(uint32_t aFrameIndex, uint64_t aCompletedFrameValue);
+    // Records this frame's copies, mip generation and layout transitions, outside of any render pass and before the
+    // passes that sample. Handles returned afterwards may only be used by this frame and later ones.
+    void Record(VkCommandBuffer aCommandBuffer, uint64_t aFrameValue);
+
+    uint32_t GetSampledImageHandle(TextureId aTextureId) const;
+    uint32_t GetSamplerHandle() const { return mySamplerHandle; }
+    bool IsResident(TextureId aTextureId) const;
+
+    uint32_t GetPendingCount() const { return static_cast<uint32_t>(myPendingTextureIds.size()); }
+    VkDeviceSize GetAllocatedBytes() const { return myAllocatedBytes; }
+    VkDeviceSize GetMemoryBudget() const { return myMemoryBudget; }
+
+private:
+    struct Texture
+    {
+        TextureData mySource;
+        TextureFormatInfo myFormatInfo;
+        VkImage myVkImage = nullptr;
+        MemoryAllocation myAllocation;
+        VkImageView myVkImageView = nullptr;
+        uint32_t myHandle = BindlessDescriptors::ourInvalidHandle;
+        uint32_t myLevelCount = 0;
+        // Finest level that can be sampled; myLevelCount while none can.
+        uint32_t myResidentLevel = 0;
+        uint32_t myUploadLevel = 0;
+        uint32_t myUploadedRowCount = 0;
+        bool myGeneratesMips = false;
+        bool myIsUsed = false;
+    };
+
+    // Views are replaced as finer levels arrive, and released textures go as a whole, once no frame can use them.
+    struct RetiredResource
+    {
+        VkImage myVkImage = nullptr;
+        VkImageView myVkImageView = nullptr;
+        MemoryAllocation myAllocation;
+        uint64_t myLastFrameValue = 0;
+    };
+
+    bool UploadRows(VkCommandBuffer aCommandBuffer, Texture& aTexture);
+    bool FinishLevel(VkCommandBuffer aCommandBuffer, Texture& aTexture, uint64_t aFrameValue);
+    void GenerateMips(VkCommandBuffer aCommandBuffer, const Texture& aTexture) const;
+    void UpdateView(Texture& aTexture, uint64_t aFrameValue);
+    void DestroyResource(RetiredResource& aResource);
+
+    VkDevice myVkDevice;
+    VkPhysicalDevice myVkPhysicalDevice;
+    VkSampler myVkSampler;
+    DeviceMemoryAllocator* myAllocator;
+    BindlessDescriptors* myBindlessDescriptors;
+    LinearArena myStagingArena;
+    std::vector<Texture> myTextures;
+    std::vector<TextureId> myFreeTextureIds;
+    std::deque<TextureId> myPendingTextureIds;
+    std::vector<RetiredResource> myRetiredResources;
+    TextureId myFallbackTextureId;
+    uint32_t mySamplerHandle;
+    VkDeviceSize myAllocatedBytes;
+    VkDeviceSize myMemoryBudget;
+    bool myIsBlockCompressionEnabled;
+};
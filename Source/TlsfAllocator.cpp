@@ -0,0 +1,282 @@
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace TlsfAllocatorPrivate
+{
+    static uint32_t FindLastSetBit(uint64_t aValue)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, aValue);
+        return static_cast<uint32_t>(index);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(aValue));
+#endif
+    }
+
+    static uint32_t FindFirstSetBit(uint64_t aValue)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, aValue);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(aValue));
+#endif
+    }
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t aSize)
+    : myFirstLevelBitmap(0)
+    , mySize(aSize)
+    , myUsedSize(0)
+    , myAllocationCount(0)
+{
+    for (uint32_t firstLevel = 0; firstLevel < ourFirstLevelCount; firstLevel++)
+    {
+        mySecondLevelBitmaps[firstLevel] = 0;
+        std::fill(std::begin(myFreeLists[firstLevel]), std::end(myFreeLists[firstLevel]), ourInvalidHandle);
+    }
+
+    const uint32_t nodeIndex = CreateNode();
+    myNodes[nodeIndex].mySize = aSize;
+    InsertFreeNode(nodeIndex);
+}
+
+uint32_t TlsfAllocator::Allocate(uint64_t aSize, uint64_t anAlignment, uint64_t& anOutOffset)
+{
+    if (aSize == 0 || aSize > mySize)
+        return ourInvalidHandle;
+
+    // Searching for the worst-case padding guarantees any node found fits once aligned. When nothing is that large,
+    // the list the size itself maps to may still hold a node that fits, e.g. the whole of a dedicated block.
+    const uint64_t alignment = std::max<uint64_t>(anAlignment, 1);
+    uint32_t nodeIndex = aSize + alignment - 1 <= mySize ? FindFreeNode(aSize + alignment - 1) : ourInvalidHandle;
+    if (nodeIndex == ourInvalidHandle)
+        nodeIndex = FindFittingNodeInList(aSize, alignment);
+
+    if (nodeIndex == ourInvalidHandle)
+        return ourInvalidHandle;
+
+    RemoveFreeNode(nodeIndex);
+
+    const uint64_t alignedOffset = (myNodes[nodeIndex].myOffset + alignment - 1) / alignment * alignment;
+    const uint64_t padding = alignedOffset - myNodes[nodeIndex].myOffset;
+    if (padding > 0)
+    {
+        const uint32_t paddingNodeIndex = nodeIndex;
+        nodeIndex = SplitNode(paddingNodeIndex, padding);
+        InsertFreeNode(paddingNodeIndex);
+    }
+
+    if (myNodes[nodeIndex].mySize > aSize)
+        InsertFreeNode(SplitNode(nodeIndex, aSize));
+
+    myNodes[nodeIndex].myIsFree = false;
+    myUsedSize += aSize;
+    myAllocationCount++;
+
+    anOutOffset = alignedOffset;
+    return nodeIndex;
+}
+
+void TlsfAllocator::Free(uint32_t aHandle)
+{
+    uint32_t nodeIndex = aHandle;
+
+    myUsedSize -= myNodes[nodeIndex].mySize;
+    myAllocationCount--;
+
+    const uint32_t nextIndex = myNodes[nodeIndex].myNextPhysical;
+    if (nextIndex != ourInvalidHandle && myNodes[nextIndex].myIsFree)
+    {
+        RemoveFreeNode(nextIndex);
+        myNodes[nodeIndex].mySize += myNodes[nextIndex].mySize;
+        myNodes[nodeIndex].myNextPhysical = myNodes[nextIndex].myNextPhysical;
+        if (myNodes[nodeIndex].myNextPhysical != ourInvalidHandle)
+            myNodes[myNodes[nodeIndex].myNextPhysical].myPreviousPhysical = nodeIndex;
+
+        ReleaseNode(nextIndex);
+    }
+
+    const uint32_t previousIndex = myNodes[nodeIndex].myPreviousPhysical;
+    if (previousIndex != ourInvalidHandle && myNodes[previousIndex].myIsFree)
+    {
+        RemoveFreeNode(previousIndex);
+        myNodes[previousIndex].mySize += myNodes[nodeIndex].mySize;
+        myNodes[previousIndex].myNextPhysical = myNodes[nodeIndex].myNextPhysical;
+        if (myNodes[previousIndex].myNextPhysical != ourInvalidHandle)
+            myNodes[myNodes[previousIndex].myNextPhysical].myPreviousPhysical = previousIndex;
+
+        ReleaseNode(nodeIndex);
+        nodeIndex = previousIndex;
+    }
+
+    InsertFreeNode(nodeIndex);
+}
+
+uint64_t TlsfAllocator::GetLargestFreeRange() const
+{
+    if (myFirstLevelBitmap == 0)
+        return 0;
+
+    const uint32_t firstLevel = TlsfAllocatorPrivate::FindLastSetBit(myFirstLevelBitmap);
+    const uint32_t secondLevel = TlsfAllocatorPrivate::FindLastSetBit(mySecondLevelBitmaps[firstLevel]);
+
+    uint64_t largestSize = 0;
+    for (uint32_t nodeIndex = myFreeLists[firstLevel][secondLevel]; nodeIndex != ourInvalidHandle; nodeIndex = myNodes[nodeIndex].myNextFree)
+        largestSize = std::max(largestSize, myNodes[nodeIndex].mySize);
+
+    return largestSize;
+}
+
+void TlsfAllocator::GetListIndices(uint64_t aSize, uint32_t& anOutFirstLevel, uint32_t& anOutSecondLevel)
+{
+    // Sizes below the second level count are spread linearly over the first list, larger ones
+    // get a power-of-two first level split into ourSecondLevelCount linear steps.
+    if (aSize < ourSecondLevelCount)
+    {
+        anOutFirstLevel = 0;
+        anOutSecondLevel = static_cast<uint32_t>(aSize);
+        return;
+    }
+
+    const uint32_t lastSetBit = TlsfAllocatorPrivate::FindLastSetBit(aSize);
+    anOutFirstLevel = lastSetBit - ourSecondLevelLog2 + 1;
+    anOutSecondLevel = static_cast<uint32_t>(aSize >> (lastSetBit - ourSecondLevelLog2)) - ourSecondLevelCount;
+}
+
+uint32_t TlsfAllocator::FindFreeNode(uint64_t aSize) const
+{
+    // Round up to the next list so every node in the list found is large enough.
+    uint64_t roundedSize = aSize;
+    if (aSize >= ourSecondLevelCount)
+        roundedSize += (uint64_t(1) << (TlsfAllocatorPrivate::FindLastSetBit(aSize) - ourSecondLevelLog2)) - 1;
+
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    GetListIndices(roundedSize, firstLevel, secondLevel);
+
+    uint32_t secondLevelBitmap = mySecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelBitmap == 0)
+    {
+        const uint64_t firstLevelBitmap = firstLevel + 1 < ourFirstLevelCount ? myFirstLevelBitmap & (~uint64_t(0) << (firstLevel + 1)) : 0;
+        if (firstLevelBitmap == 0)
+            return ourInvalidHandle;
+
+        firstLevel = TlsfAllocatorPrivate::FindFirstSetBit(firstLevelBitmap);
+        secondLevelBitmap = mySecondLevelBitmaps[firstLevel];
+    }
+
+    secondLevel = TlsfAllocatorPrivate::FindFirstSetBit(secondLevelBitmap);
+    return myFreeLists[firstLevel][secondLevel];
+}
+
+uint32_t TlsfAllocator::FindFittingNodeInList(uint64_t aSize, uint64_t anAlignment) const
+{
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    GetListIndices(aSize, firstLevel, secondLevel);
+
+    for (uint32_t nodeIndex = myFreeLists[firstLevel][secondLevel]; nodeIndex != ourInvalidHandle; nodeIndex = myNodes[nodeIndex].myNextFree)
+    {
+        const Node& node = myNodes[nodeIndex];
+        const uint64_t alignedOffset = (node.myOffset + anAlignment - 1) / anAlignment * anAlignment;
+        if (alignedOffset + aSize <= node.myOffset + node.mySize)
+            return nodeIndex;
+    }
+
+    return ourInvalidHandle;
+}
+
+uint32_t TlsfAllocator::CreateNode()
+{
+    if (!myUnusedNodes.empty())
+    {
+        const uint32_t nodeIndex = myUnusedNodes.back();
+        myUnusedNodes.pop_back();
+        myNodes[nodeIndex] = Node();
+        return nodeIndex;
+    }
+
+    myNodes.emplace_back();
+    return static_cast<uint32_t>(myNodes.size() - 1);
+}
+
+void TlsfAllocator::ReleaseNode(uint32_t aNodeIndex)
+{
+    myUnusedNodes.push_back(aNodeIndex);
+}
+
+void TlsfAllocator::InsertFreeNode(uint32_t aNodeIndex)
+{
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    GetListIndices(myNodes[aNodeIndex].mySize, firstLevel, secondLevel);
+
+    Node& node = myNodes[aNodeIndex];
+    node.myIsFree = true;
+    node.myPreviousFree = ourInvalidHandle;
+    node.myNextFree = myFreeLists[firstLevel][secondLevel];
+
+    if (node.myNextFree != ourInvalidHandle)
+        myNodes[node.myNextFree].myPreviousFree = aNodeIndex;
+
+    myFreeLists[firstLevel][secondLevel] = aNodeIndex;
+    mySecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+    myFirstLevelBitmap |= uint64_t(1) << firstLevel;
+}
+
+void TlsfAllocator::RemoveFreeNode(uint32_t aNodeIndex)
+{
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    GetListIndices(myNodes[aNodeIndex].mySize, firstLevel, secondLevel);
+
+    Node& node = myNodes[aNodeIndex];
+    if (node.myPreviousFree != ourInvalidHandle)
+        myNodes[node.myPreviousFree].myNextFree = node.myNextFree;
+    else
+        myFreeLists[firstLevel][secondLevel] = node.myNextFree;
+
+    if (node.myNextFree != ourInvalidHandle)
+        myNodes[node.myNextFree].myPreviousFree = node.myPreviousFree;
+
+    if (myFreeLists[firstLevel][secondLevel] == ourInvalidHandle)
+    {
+        mySecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+        if (mySecondLevelBitmaps[firstLevel] == 0)
+            myFirstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+    }
+
+    node.myIsFree = false;
+    node.myPreviousFree = ourInvalidHandle;
+    node.myNextFree = ourInvalidHandle;
+}
+
+uint32_t TlsfAllocator::SplitNode(uint32_t aNodeIndex, uint64_t aSize)
+{
+    // Keeps the first aSize bytes in aNodeIndex and returns a new node for the remainder.
+    const uint32_t remainderIndex = CreateNode();
+
+    Node& node = myNodes[aNodeIndex];
+    Node& remainder = myNodes[remainderIndex];
+
+    remainder.myOffset = node.myOffset + aSize;
+    remainder.mySize = node.mySize - aSize;
+    remainder.myPreviousPhysical = aNodeIndex;
+    remainder.myNextPhysical = node.myNextPhysical;
+
+    if (remainder.myNextPhysical != ourInvalidHandle)
+        myNodes[remainder.myNextPhysical].myPreviousPhysical = remainderIndex;
+
+    node.mySize = aSize;
+    node.myNextPhysical = remainderIndex;
+
+    return remainderIndex;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit allocator over an abstract range of [0, size) bytes. It never touches memory itself,
+// the caller maps the returned offsets onto a VkDeviceMemory block. Allocation and free are O(1), and neighbouring
+// free ranges are merged immediately.
+class TlsfAllocator
+{
+public:
+    static constexpr uint32_t ourInvalidHandle = UINT32_MAX;
+
+    explicit TlsfAllocator(uint64_t aSize);
+
+    // Returns ourInvalidHandle when no free range is large enough.
+    uint32_t Allocate(uint64_t aSize, uint64_t anAlignment, uint64_t& anOutOffset);
+    void Free(uint32_t aHandle);
+
+    uint64_t GetSize() const { return mySize; }
+    uint64_t GetUsedSize() const { return myUsedSize; }
+    uint32_t GetAllocationCount() const { return myAllocationCount; }
+    uint64_t GetLargestFreeRange() const;
+    bool IsEmpty() const { return myAllocationCount == 0; }
+
+private:
+    static constexpr uint32_t ourSecondLevelLog2 = 4;
+    static constexpr uint32_t ourSecondLevelCount = 1 << ourSecondLevelLog2;
+    static constexpr uint32_t ourFirstLevelCount = 64;
+
+    struct Node
+    {
+        uint64_t myOffset = 0;
+        uint64_t mySize = 0;
+        uint32_t myPreviousPhysical = ourInvalidHandle;
+        uint32_t myNextPhysical = ourInvalidHandle;
+        uint32_t myPreviousFree = ourInvalidHandle;
+        uint32_t myNextFree = ourInvalidHandle;
+        bool myIsFree = false;
+    };
+
+    static void GetListIndices(uint64_t aSize, uint32_t& anOutFirstLevel, uint32_t& anOutSecondLevel);
+    uint32_t FindFreeNode(uint64_t aSize) const;
+    uint32_t FindFittingNodeInList(uint64_t aSize, uint64_t anAlignment) const;
+    uint32_t CreateNode();
+    void ReleaseNode(uint32_t aNodeIndex);
+    void InsertFreeNode(uint32_t aNodeIndex);
+    void RemoveFreeNode(uint32_t aNodeIndex);
+    uint32_t SplitNode(uint32_t aNodeIndex, uint64_t aSize);
+
+    std::vector<Node> myNodes;
+    std::vector<uint32_t> myUnusedNodes;
+    uint32_t myFreeLists[ourFirstLevelCount][ourSecondLevelCount];
+    uint32_t mySecondLevelBitmaps[ourFirstLevelCount];
+    uint64_t myFirstLevelBitmap;
+    uint64_t mySize;
+    uint64_t myUsedSize;
+    uint32_t myAllocationCount;
+};
@@ -0,0 +1,110 @@
+#include "UniformRing.h"
+
+#include <cstring>
+#include <stdexcept>
+
+UniformRing::UniformRing()
+    : myVkDevice(nullptr)
+    , myVkDescriptorSetLayout(nullptr)
+    , myVkDescriptorPool(nullptr)
+    , myVkDescriptorSet(nullptr)
+    , myOffsetAlignment(1)
+    , myMaxRange(0)
+{
+}
+
+void UniformRing::Create(VkDevice aDevice, DeviceMemoryAllocator& anAllocator, const VkPhysicalDeviceLimits& someLimits, VkDeviceSize aFrameCapacity, uint32_t aFrameCount, VkDeviceSize aMaxRange, VkShaderStageFlags someStages)
+{
+    if (aMaxRange > someLimits.maxUniformBufferRange)
+        throw std::runtime_error("uniform ring range exceeds the device limit!");
+
+    myVkDevice = aDevice;
+    myOffsetAlignment = someLimits.minUniformBufferOffsetAlignment;
+    myMaxRange = aMaxRange;
+
+    myArena.Create(anAllocator, aFrameCapacity, aFrameCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    binding.descriptorCount = 1;
+    binding.stageFlags = someStages;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(myVkDevice, &layoutInfo, nullptr, &myVkDescriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create uniform ring descriptor set layout!");
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(myVkDevice, &poolInfo, nullptr, &myVkDescriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create uniform ring descriptor pool!");
+
+    VkDescriptorSetAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = myVkDescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &myVkDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(myVkDevice, &allocateInfo, &myVkDescriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate uniform ring descriptor set!");
+
+    // Written once: the descriptor always points at the start of the ring, and every Push is reached by its offset.
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = myArena.GetVkBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = myMaxRange;
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = myVkDescriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(myVkDevice, 1, &write, 0, nullptr);
+}
+
+void UniformRing::Destroy()
+{
+    if (!myVkDevice)
+        return;
+
+    vkDestroyDescriptorPool(myVkDevice, myVkDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(myVkDevice, myVkDescriptorSetLayout, nullptr);
+    myArena.Destroy();
+
+    myVkDescriptorSet = nullptr;
+    myVkDescriptorPool = nullptr;
+    myVkDescriptorSetLayout = nullptr;
+    myVkDevice = nullptr;
+}
+
+uint32_t UniformRing::Push(const void* someData, VkDeviceSize aSize)
+{
+    if (aSize > myMaxRange)
+        throw std::runtime_error("uniform block is larger than the uniform ring range!");
+
+    // Shaders read myMaxRange bytes from the offset, so the whole range has to stay inside this frame's segment.
+    const ArenaAllocation allocation = myArena.Allocate(myMaxRange, myOffsetAlignment);
+    std::memcpy(allocation.myMappedData, someData, static_cast<size_t>(aSize));
+
+    return static_cast<uint32_t>(allocation.myOffset);
+}
+
+void UniformRing::Bind(VkCommandBuffer aCommandBuffer, VkPipelineBindPoint aBindPoint, VkPipelineLayout aPipelineLayout, uint32_t aSetIndex, uint32_t aDynamicOffset) const
+{
+    vkCmdBindDescriptorSets(aCommandBuffer, aBindPoint, aPipelineLayout, aSetIndex, 1, &myVkDescriptorSet, 1, &aDynamicOffset);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "LinearArena.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+// Per-frame uniform data in a persistently mapped LinearArena, exposed through one dynamic uniform buffer descriptor.
+// Push copies a value into the current frame's segment and returns the dynamic offset to bind it with, so per-frame
+// updates cost one memcpy: no allocation, no vkMapMemory and no descriptor writes. Push is lock-free and may be
+// called from recording threads; BeginFrame must not race with it.
+class UniformRing
+{
+public:
+    UniformRing();
+
+    // aMaxRange is the largest block a single Push may write, and the range shaders see through the descriptor.
+    void Create(VkDevice aDevice, DeviceMemoryAllocator& anAllocator, const VkPhysicalDeviceLimits& someLimits, VkDeviceSize aFrameCapacity, uint32_t aFrameCount, VkDeviceSize aMaxRange, VkShaderStageFlags someStages);
+    void Destroy();
+
+    void BeginFrame(uint32_t aFrameIndex) { myArena.BeginFrame(aFrameIndex); }
+
+    uint32_t Push(const void* someData, VkDeviceSize aSize);
+    template <typename T>
+    uint32_t Push(const T& aValue) { return Push(&aValue, sizeof(T)); }
+
+    void Bind(VkCommandBuffer aCommandBuffer, VkPipelineBindPoint aBindPoint, VkPipelineLayout aPipelineLayout, uint32_t aSetIndex, uint32_t aDynamicOffset) const;
+
+    VkDescriptorSetLayout GetVkDescriptorSetLayout() const { return myVkDescriptorSetLayout; }
+    const LinearArena& GetArena() const { return myArena; }
+
+private:
+    VkDevice myVkDevice;
+    VkDescriptorSetLayout myVkDescriptorSetLayout;
+    VkDescriptorPool myVkDescriptorPool;
+    VkDescriptorSet myVkDescriptorSet;
+    LinearArena myArena;
+    VkDeviceSize myOffsetAlignment;
+    VkDeviceSize myMaxRange;
+};
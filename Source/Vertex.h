@@ -0,0 +1,33 @@
+#pragma once
+
+#include "VertexLayout.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+struct Vertex
+{
+    glm::vec2 myPosition;
+    glm::vec3 myColor;
+};
+
+struct InstanceData
+{
+    glm::vec2 myOffset;
+    float myScale;
+};
+
+// Per-vertex data in binding 0, per-instance data in binding 1.
+inline const VertexLayout& GetSceneVertexLayout()
+{
+    static const VertexLayout layout = VertexLayout()
+        .AddBinding(0, sizeof(Vertex))
+        .AddBinding(1, sizeof(InstanceData), VK_VERTEX_INPUT_RATE_INSTANCE)
+        .AddAttribute(0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, myPosition))
+        .AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, myColor))
+        .AddAttribute(2, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(InstanceData, myOffset))
+        .AddAttribute(3, 1, VK_FORMAT_R32_SFLOAT, offsetof(InstanceData, myScale));
+
+    return layout;
+}
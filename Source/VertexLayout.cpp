@@ -0,0 +1,36 @@
+#include "VertexLayout.h"
+
+VertexLayout& VertexLayout::AddBinding(uint32_t aBinding, uint32_t aStride, VkVertexInputRate anInputRate)
+{
+    VkVertexInputBindingDescription binding = {};
+    binding.binding = aBinding;
+    binding.stride = aStride;
+    binding.inputRate = anInputRate;
+    myBindings.push_back(binding);
+
+    return *this;
+}
+
+VertexLayout& VertexLayout::AddAttribute(uint32_t aLocation, uint32_t aBinding, VkFormat aFormat, uint32_t anOffset)
+{
+    VkVertexInputAttributeDescription attribute = {};
+    attribute.location = aLocation;
+    attribute.binding = aBinding;
+    attribute.format = aFormat;
+    attribute.offset = anOffset;
+    myAttributes.push_back(attribute);
+
+    return *this;
+}
+
+VkPipelineVertexInputStateCreateInfo VertexLayout::GetVertexInputStateCreateInfo() const
+{
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(myBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = myBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(myAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = myAttributes.data();
+
+    return vertexInputInfo;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+// Describes the vertex buffers a pipeline reads, once, next to the vertex struct it matches.
+class VertexLayout
+{
+public:
+    VertexLayout& AddBinding(uint32_t aBinding, uint32_t aStride, VkVertexInputRate anInputRate = VK_VERTEX_INPUT_RATE_VERTEX);
+    VertexLayout& AddAttribute(uint32_t aLocation, uint32_t aBinding, VkFormat aFormat, uint32_t anOffset);
+
+    // The returned struct points into this layout, so the layout must outlive pipeline creation.
+    VkPipelineVertexInputStateCreateInfo GetVertexInputStateCreateInfo() const;
+
+private:
+    std::vector<VkVertexInputBindingDescription> myBindings;
+    std::vector<VkVertexInputAttributeDescription> myAttributes;
+};
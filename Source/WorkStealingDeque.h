@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev deque with the memory orderings of Lê et al., "Correct and Efficient Work-Stealing for Weak Memory
+// Models". The owning thread pushes and pops at the bottom; any thread steals from the top. T must be trivially
+// copyable, typically a pointer. The buffer grows when full, and retired buffers are kept until destruction since
+// thieves may still read from them.
+template <typename T>
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque(int64_t aCapacity = 1024)
+        : myTop(0)
+        , myBottom(0)
+    {
+        myBuffers.push_back(std::make_unique<Buffer>(aCapacity));
+        myBuffer.store(myBuffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only.
+    void Push(T anItem)
+    {
+        const int64_t bottom = myBottom.load(std::memory_order_relaxed);
+        const int64_t top = myTop.load(std::memory_order_acquire);
+        Buffer* buffer = myBuffer.load(std::memory_order_relaxed);
+
+        if (bottom - top > buffer->myCapacity - 1)
+            buffer = Grow(buffer, top, bottom);
+
+        buffer->Store(bottom, anItem);
+        myBottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only. Takes the most recently pushed item.
+    bool Pop(T& anItem)
+    {
+        const int64_t bottom = myBottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = myBuffer.load(std::memory_order_relaxed);
+        myBottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = myTop.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            myBottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        anItem = buffer->Load(bottom);
+        if (top != bottom)
+            return true;
+
+        // The last item; race the thieves for it.
+        const bool isTaken = myTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        myBottom.store(bottom + 1, std::memory_order_relaxed);
+        return isTaken;
+    }
+
+    // Any thread. Takes the least recently pushed item, and fails spuriously when another thread wins the race.
+    bool Steal(T& anItem)
+    {
+        int64_t top = myTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = myBottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return false;
+
+        Buffer* buffer = myBuffer.load(std::memory_order_acquire);
+        anItem = buffer->Load(top);
+        return myTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    bool IsEmpty() const
+    {
+        const int64_t top = myTop.load(std::memory_order_acquire);
+        const int64_t bottom = myBottom.load(std::memory_order_acquire);
+        return top >= bottom;
+    }
+
+private:
+    struct Buffer
+    {
+        explicit Buffer(int64_t aCapacity)
+            : myCapacity(aCapacity)
+            , myItems(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(aCapacity)))
+        {
+        }
+
+        // Capacities are powers of two, so indices wrap with a mask.
+        void Store(int64_t anIndex, T anItem) { myItems[anIndex & (myCapacity - 1)].store(anItem, std::memory_order_relaxed); }
+        T Load(int64_t anIndex) const { return myItems[anIndex & (myCapacity - 1)].load(std::memory_order_relaxed); }
+
+        int64_t myCapacity;
+        std::unique_ptr<std::atomic<T>[]> myItems;
+    };
+
+    Buffer* Grow(Buffer* aBuffer, int64_t aTop, int64_t aBottom)
+    {
+        myBuffers.push_back(std::make_unique<Buffer>(aBuffer->myCapacity * 2));
+        Buffer* buffer = myBuffers.back().get();
+
+        for (int64_t i = aTop; i < aBottom; i++)
+            buffer->Store(i, aBuffer->Load(i));
+
+        myBuffer.store(buffer, std::memory_order_release);
+        return buffer;
+    }
+
+    std::atomic<int64_t> myTop;
+    std::atomic<int64_t> myBottom;
+    std::atomic<Buffer*> myBuffer;
+    // Owner only.
+    std::vector<std::unique_ptr<Buffer>> myBuffers;
+};
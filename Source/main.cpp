@@ -1,13 +1,19 @@
+#include "ApplicationSettings.h"
+#include "CpuTracer.h"
 #include "HelloTriangleApp.h"
 
 #include <iostream>
 
-int main()
+int main(int anArgumentCount, char* someArguments[])
 {
-    HelloTriangleApp app;
-
     try
     {
+        const ApplicationSettings settings = ApplicationSettings::FromCommandLine(anArgumentCount, someArguments);
+
+        CpuTracer::SetEnabled(!settings.myTracePath.empty());
+        CpuTracer::SetThreadName("Main");
+
+        HelloTriangleApp app(settings);
         app.Run();
     }
     catch (const std::exception& anException)
@@ -0,0 +1,128 @@
+#include "AssetArchiveFormat.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Packs every file below an input directory into an asset archive, named by its path relative to that directory.
+// Usage: AssetPacker <output archive> <input directory>
+
+namespace AssetPackerPrivate
+{
+    struct PackedAsset
+    {
+        std::string myName;
+        std::vector<char> myData;
+        AssetArchiveEntry myEntry = {};
+    };
+
+    static uint64_t Align(uint64_t anOffset, uint64_t anAlignment)
+    {
+        return (anOffset + anAlignment - 1) / anAlignment * anAlignment;
+    }
+
+    static std::vector<char> ReadFile(const std::filesystem::path& aPath)
+    {
+        std::ifstream file(aPath, std::ios::binary);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open " + aPath.generic_string() + "!");
+
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+int main(int anArgumentCount, char* someArguments[])
+{
+    using namespace AssetPackerPrivate;
+
+    if (anArgumentCount != 3)
+    {
+        std::cerr << "usage: AssetPacker <output archive> <input directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const std::filesystem::path outputPath = someArguments[1];
+        const std::filesystem::path inputDirectory = someArguments[2];
+
+        std::vector<PackedAsset> assets;
+        for (const std::filesystem::directory_entry& directoryEntry : std::filesystem::recursive_directory_iterator(inputDirectory))
+        {
+            if (!directoryEntry.is_regular_file())
+                continue;
+
+            PackedAsset asset;
+            asset.myName = std::filesystem::relative(directoryEntry.path(), inputDirectory).generic_string();
+            asset.myData = ReadFile(directoryEntry.path());
+            assets.push_back(std::move(asset));
+        }
+
+        // Sorting by name first keeps the output identical between runs when two names share a hash.
+        std::sort(assets.begin(), assets.end(), [](const PackedAsset& aFirst, const PackedAsset& aSecond) { return aFirst.myName < aSecond.myName; });
+        for (PackedAsset& asset : assets)
+            asset.myEntry.myNameHash = HashAssetBytes(asset.myName.data(), asset.myName.size());
+
+        std::stable_sort(assets.begin(), assets.end(), [](const PackedAsset& aFirst, const PackedAsset& aSecond) { return aFirst.myEntry.myNameHash < aSecond.myEntry.myNameHash; });
+
+        AssetArchiveHeader header = {};
+        header.myMagic = ourAssetArchiveMagic;
+        header.myVersion = ourAssetArchiveVersion;
+        header.myEntryCount = static_cast<uint32_t>(assets.size());
+        header.myIndexOffset = sizeof(AssetArchiveHeader);
+        header.myNamesOffset = header.myIndexOffset + assets.size() * sizeof(AssetArchiveEntry);
+
+        std::string names;
+        for (PackedAsset& asset : assets)
+        {
+            asset.myEntry.myNameOffset = static_cast<uint32_t>(names.size());
+            asset.myEntry.myNameLength = static_cast<uint32_t>(asset.myName.size());
+            names += asset.myName;
+        }
+
+        uint64_t dataOffset = header.myNamesOffset + names.size();
+        for (PackedAsset& asset : assets)
+        {
+            dataOffset = Align(dataOffset, ourAssetArchiveDataAlignment);
+            asset.myEntry.myDataOffset = dataOffset;
+            asset.myEntry.myDataSize = asset.myData.size();
+            asset.myEntry.myContentHash = HashAssetBytes(asset.myData.data(), asset.myData.size());
+            dataOffset += asset.myData.size();
+        }
+
+        std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to create " + outputPath.generic_string() + "!");
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const PackedAsset& asset : assets)
+            file.write(reinterpret_cast<const char*>(&asset.myEntry), sizeof(asset.myEntry));
+
+        file.write(names.data(), names.size());
+
+        for (const PackedAsset& asset : assets)
+        {
+            const std::vector<char> padding(static_cast<size_t>(asset.myEntry.myDataOffset - static_cast<uint64_t>(file.tellp())), 0);
+            file.write(padding.data(), padding.size());
+            file.write(asset.myData.data(), asset.myData.size());
+        }
+
+        if (!file)
+            throw std::runtime_error("failed to write " + outputPath.generic_string() + "!");
+
+        std::cout << "Packed " << assets.size() << " assets into " << outputPath.generic_string() << std::endl;
+    }
+    catch (const std::exception& anException)
+    {
+        std::cerr << anException.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Measures the job system's scheduling overhead with empty jobs, and its scaling with jobs doing a fixed amount of
+// arithmetic, from 1 thread up to a maximum, doubling each step.
+// Usage: JobSystemBenchmark [max thread count, 64 by default]
+
+namespace JobSystemBenchmarkPrivate
+{
+    static constexpr uint32_t ourDefaultMaxThreadCount = 64;
+    static constexpr uint32_t ourRepetitionCount = 5;
+    static constexpr uint32_t ourEmptyJobCount = 100000;
+    static constexpr uint32_t ourChainLength = 10000;
+    static constexpr uint32_t ourTreeDepth = 14;
+    static constexpr uint32_t ourWorkJobCount = 4096;
+    static constexpr uint32_t ourWorkIterationCount = 20000;
+
+    // Keeps results alive so the optimizer cannot drop the work.
+    static std::atomic<uint64_t> ourSink(0);
+
+    // Best of several runs, in nanoseconds, since the first run also pays for thread start-up and page faults.
+    template <typename Function>
+    static double Measure(const Function& aFunction)
+    {
+        double bestNs = 0.0;
+        for (uint32_t i = 0; i < ourRepetitionCount; i++)
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            aFunction();
+            const double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            bestNs = i == 0 ? elapsedNs : std::min(bestNs, elapsedNs);
+        }
+
+        return bestNs;
+    }
+
+    static void SpawnEmptyJobs(JobSystem& aJobSystem)
+    {
+        JobCounter counter;
+        for (uint32_t i = 0; i < ourEmptyJobCount; i++)
+            aJobSystem.Run([]() {}, counter);
+
+        aJobSystem.Wait(counter);
+    }
+
+    static void RunEmptyParallelFor(JobSystem& aJobSystem)
+    {
+        aJobSystem.ParallelFor(ourEmptyJobCount, [](uint32_t) {});
+    }
+
+    // Every job depends on the previous one, so this is pure dependency latency.
+    static void RunDependencyChain(JobSystem& aJobSystem)
+    {
+        const std::unique_ptr<JobCounter[]> counters = std::make_unique<JobCounter[]>(ourChainLength);
+
+        aJobSystem.Run([]() {}, counters[0]);
+        for (uint32_t i = 1; i < ourChainLength; i++)
+            aJobSystem.RunAfter(counters[i - 1], []() {}, counters[i]);
+
+        aJobSystem.Wait(counters[ourChainLength - 1]);
+    }
+
+    // Jobs that spawn two children and wait for them, which exercises stealing and waiting inside jobs.
+    static void SpawnTree(JobSystem& aJobSystem, uint32_t aDepth)
+    {
+        if (aDepth == 0)
+            return;
+
+        JobCounter counter;
+        aJobSystem.Run([&aJobSystem, aDepth]() { SpawnTree(aJobSystem, aDepth - 1); }, counter);
+        aJobSystem.Run([&aJobSystem, aDepth]() { SpawnTree(aJobSystem, aDepth - 1); }, counter);
+        aJobSystem.Wait(counter);
+    }
+
+    static void DoWork(uint32_t aSeed)
+    {
+        uint64_t value = aSeed + 1;
+        for (uint32_t i = 0; i < ourWorkIterationCount; i++)
+            value = value * 6364136223846793005ull + 1442695040888963407ull;
+
+        ourSink.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static void RunWork(JobSystem& aJobSystem)
+    {
+        aJobSystem.ParallelFor(ourWorkJobCount, [](uint32_t anIndex) { DoWork(anIndex); });
+    }
+}
+
+int main(int anArgumentCount, char* someArguments[])
+{
+    using namespace JobSystemBenchmarkPrivate;
+
+    if (anArgumentCount > 2)
+    {
+        std::cerr << "usage: JobSystemBenchmark [max thread count]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const uint32_t maxThreadCount = anArgumentCount == 2 ? static_cast<uint32_t>(std::stoul(someArguments[1])) : ourDefaultMaxThreadCount;
+        if (maxThreadCount == 0)
+            throw std::runtime_error("the thread count must be at least 1!");
+
+        const uint32_t treeJobCount = (1u << (ourTreeDepth + 1)) - 2;
+
+        std::cout << std::right << std::setw(8) << "Threads" << std::setw(14) << "Spawn ns" << std::setw(14) << "For ns"
+            << std::setw(14) << "Chain ns" << std::setw(14) << "Tree ns" << std::setw(14) << "Work ms" << std::setw(10) << "Speedup" << std::endl;
+
+        double singleThreadWorkNs = 0.0;
+        for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+        {
+            JobSystem jobSystem(threadCount - 1);
+
+            // Per job, including the wait at the end.
+            const double spawnNs = Measure([&jobSystem]() { SpawnEmptyJobs(jobSystem); }) / ourEmptyJobCount;
+            const double parallelForNs = Measure([&jobSystem]() { RunEmptyParallelFor(jobSystem); }) / ourEmptyJobCount;
+            const double chainNs = Measure([&jobSystem]() { RunDependencyChain(jobSystem); }) / ourChainLength;
+            const double treeNs = Measure([&jobSystem]() { SpawnTree(jobSystem, ourTreeDepth); }) / treeJobCount;
+            const double workNs = Measure([&jobSystem]() { RunWork(jobSystem); });
+
+            if (threadCount == 1)
+                singleThreadWorkNs = workNs;
+
+            std::cout << std::fixed << std::setprecision(1)
+                << std::setw(8) << threadCount << std::setw(14) << spawnNs << std::setw(14) << parallelForNs
+                << std::setw(14) << chainNs << std::setw(14) << treeNs
+                << std::setw(14) << std::setprecision(3) << workNs / 1e6
+                << std::setw(10) << std::setprecision(2) << singleThreadWorkNs / workNs
+                << std::defaultfloat << std::endl;
+        }
+    }
+    catch (const std::exception& anException)
+    {
+        std::cerr << anException.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}